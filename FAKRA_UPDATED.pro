@@ -1,8 +1,13 @@
-QT += core gui widgets
+TEMPLATE = subdirs
 
-TARGET = fakra
-TEMPLATE = app
-
-SOURCES += main.cpp mainwindow.cpp
-HEADERS += mainwindow.h
+# core: collection, storage and query engine, without any widgets
+# app:  the Qt Widgets front end
+# cli:  batch queries from the command line
+# bench: QtTest benchmarks over generated corpora ("make benchmark")
+# tests: QtTest checks of the query server ("make check")
+SUBDIRS = core app cli bench tests
 
+app.depends = core
+cli.depends = core
+bench.depends = core
+tests.depends = core
@@ -0,0 +1,9 @@
+QT += core gui widgets concurrent sql
+
+TARGET = fakra
+TEMPLATE = app
+
+include(../core/fakra_core.pri)
+
+SOURCES += completionmodel.cpp main.cpp mainwindow.cpp proverblistmodel.cpp
+HEADERS += completionmodel.h mainwindow.h proverblistmodel.h
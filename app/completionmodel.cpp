@@ -0,0 +1,64 @@
+#include "completionmodel.h"
+
+#include <algorithm>
+
+CompletionModel::CompletionModel(const CompletionIndex *completions, QObject *parent)
+    : QAbstractListModel(parent),
+    completions(completions)
+{
+}
+
+int CompletionModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return suggestions.size();
+}
+
+QVariant CompletionModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= suggestions.size()) {
+        return QVariant();
+    }
+
+    const Suggestion &suggestion = suggestions[index.row()];
+    if (role == Qt::EditRole) {
+        return suggestion.text;
+    }
+    if (role == Qt::DisplayRole) {
+        static const char *const kindNames[] = {"proverb", "word", "tag", "region"};
+        return QString("%1    %2").arg(suggestion.text, QLatin1String(kindNames[suggestion.kind]));
+    }
+
+    return QVariant();
+}
+
+void CompletionModel::setPrefix(const QString &text)
+{
+    QList<Suggestion> found;
+    for (const CompletionIndex::Completion &completion : completions->complete(text)) {
+        found.append(Suggestion{completion.text, completion.kind});
+    }
+
+    QString trimmed = text.trimmed();
+    int lastSpace = int(trimmed.lastIndexOf(' '));
+    if (found.size() < CompletionIndex::TopK && lastSpace >= 0) {
+        QString head = trimmed.left(lastSpace + 1);
+        const QList<CompletionIndex::Completion> words =
+            completions->complete(trimmed.mid(lastSpace + 1), CompletionIndex::TopK - int(found.size()));
+        for (const CompletionIndex::Completion &completion : words) {
+            QString joined = head + completion.text;
+            bool known = std::any_of(found.cbegin(), found.cend(), [&joined](const Suggestion &s) {
+                return s.text == joined;
+            });
+            if (!known) {
+                found.append(Suggestion{joined, completion.kind});
+            }
+        }
+    }
+
+    beginResetModel();
+    suggestions = found;
+    endResetModel();
+}
@@ -0,0 +1,38 @@
+#ifndef COMPLETIONMODEL_H
+#define COMPLETIONMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QString>
+
+#include "completionindex.h"
+
+// Completer model holding only the handful of suggestions for the text
+// being typed, looked up in the store's CompletionIndex. Meant for a
+// QCompleter in UnfilteredPopupCompletion mode, which shows the rows as
+// they are instead of filtering a full list itself.
+class CompletionModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit CompletionModel(const CompletionIndex *completions, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+public slots:
+    // Suggests terms starting with text; when that leaves room, the last
+    // word alone is completed too, keeping the words before it
+    void setPrefix(const QString &text);
+
+private:
+    struct Suggestion {
+        QString text;       // what the search box is set to
+        CompletionIndex::Kind kind;
+    };
+
+    const CompletionIndex *completions;
+    QList<Suggestion> suggestions;
+};
+
+#endif // COMPLETIONMODEL_H
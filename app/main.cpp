@@ -1,12 +1,18 @@
 #include <QApplication>
 #include "mainwindow.h"
+#include "metrics.h"
 
 int main(int argc, char *argv[])
 {
+    Metrics::instance().markStartupBegin();
+
     QApplication app(argc, argv);
     MainWindow window;
     window.setWindowTitle("Fakra - Maithili Proverbs Collection");
     window.setMinimumSize(900, 600);
     window.show();
-    return app.exec();
+
+    int result = app.exec();
+    Metrics::instance().writeTrace();
+    return result;
 }
@@ -0,0 +1,1018 @@
+#include "mainwindow.h"
+
+#include <QtConcurrent>
+
+MainWindow::MainWindow(QWidget *parent)
+    : QMainWindow(parent),
+    painted(false),
+    searchGeneration(0),
+    watchedGeneration(0),
+    saveDirty(false),
+    legacyFilename("proverbs.json"),
+    collectionPath("proverbs"),
+    databaseFilename("proverbs.sqlite"),
+    signaturesFilename(collectionPath + "/signatures.minhash"),
+    database(nullptr)
+{
+    // A database put in place of the shard directory is used instead of it
+    if (QFile::exists(databaseFilename)) {
+        database = new ProverbDatabase(databaseFilename);
+        backend.reset(database);
+        if (!database->isOpen()) {
+            QMessageBox::warning(this, "Error", "Could not open " + databaseFilename + ": " +
+                                 database->errorString());
+        }
+    } else {
+        backend.reset(new ProverbCollection(collectionPath));
+    }
+
+    setupUi();
+    loadProverbs();
+    loadProverbList();
+}
+
+MainWindow::~MainWindow()
+{
+    // The worker polls searchGeneration, so let it finish before it goes away
+    searchGeneration.fetchAndAddOrdered(1);
+    searchWatcher->waitForFinished();
+
+    // Every edit is already journaled; this folds the last ones into their shards
+    saveTimer->stop();
+    saveWatcher->waitForFinished();
+    if (saveDirty) {
+        backend->writeSnapshot(store.columns());
+    }
+
+    // Spares the next start from recomputing every signature
+    if (!database) {
+        store.duplicates().save(signaturesFilename);
+    }
+}
+
+void MainWindow::setupUi()
+{
+    centralWidget = new QWidget();
+    QHBoxLayout *mainLayout = new QHBoxLayout(centralWidget);
+
+    splitter = new QSplitter(Qt::Horizontal);
+
+    // Left panel setup
+    leftPanel = new QWidget();
+    leftLayout = new QVBoxLayout(leftPanel);
+
+    // Search area
+    searchLayout = new QHBoxLayout();
+    searchInput = new QLineEdit();
+    searchInput->setPlaceholderText("Search proverbs...");
+    connect(searchInput, &QLineEdit::textChanged, this, &MainWindow::searchProverbs);
+    searchLayout->addWidget(searchInput);
+
+    // Suggestions come from the store's completion trie; the completer
+    // shows them as given rather than filtering a copy of the corpus. A
+    // database keeps no trie, so it gets no completer.
+    completionModel = nullptr;
+    if (!database) {
+        completionModel = new CompletionModel(&store.completions(), this);
+        connect(searchInput, &QLineEdit::textEdited, completionModel, &CompletionModel::setPrefix);
+        QCompleter *completer = new QCompleter(completionModel, this);
+        completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+        completer->setMaxVisibleItems(CompletionIndex::TopK);
+        searchInput->setCompleter(completer);
+    }
+
+    rankedSearch = new QCheckBox("Rank by relevance");
+    connect(rankedSearch, &QCheckBox::toggled, this, &MainWindow::applyFilters);
+    searchLayout->addWidget(rankedSearch);
+
+    // Keystrokes inside this window coalesce into a single search
+    searchTimer = new QTimer(this);
+    searchTimer->setSingleShot(true);
+    searchTimer->setInterval(150);
+    connect(searchTimer, &QTimer::timeout, this, &MainWindow::applyFilters);
+
+    searchWatcher = new QFutureWatcher<FilterResult>(this);
+    connect(searchWatcher, &QFutureWatcher<FilterResult>::finished, this, &MainWindow::showSearchResults);
+
+    // A burst of edits coalesces into one background snapshot write
+    saveTimer = new QTimer(this);
+    saveTimer->setSingleShot(true);
+    saveTimer->setInterval(2000);
+    connect(saveTimer, &QTimer::timeout, this, &MainWindow::saveProverbs);
+
+    saveWatcher = new QFutureWatcher<bool>(this);
+    connect(saveWatcher, &QFutureWatcher<bool>::finished, this, &MainWindow::showSaveResult);
+
+    leftLayout->addLayout(searchLayout);
+
+    // Filter options
+    filterLayout = new QHBoxLayout();
+
+    tagFilter = new QComboBox();
+    regionFilter = new QComboBox();
+
+    filterLayout->addWidget(new QLabel("Tag:"));
+    filterLayout->addWidget(tagFilter);
+    filterLayout->addWidget(new QLabel("Region:"));
+    filterLayout->addWidget(regionFilter);
+
+    leftLayout->addLayout(filterLayout);
+
+    // Proverb list; uniform item sizes let the view skip measuring every row
+    listModel = database ? new ProverbListModel(databaseFilename, this)
+                         : new ProverbListModel(&store.columns(), this);
+    proverbList = new QListView();
+    proverbList->setUniformItemSizes(true);
+    proverbList->setModel(listModel);
+    connect(proverbList->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+            [this](const QModelIndex &current) { showSelectedProverb(current.row()); });
+    leftLayout->addWidget(proverbList);
+
+    // Buttons
+    buttonLayout = new QHBoxLayout();
+
+    addButton = new QPushButton("Add New");
+    connect(addButton, &QPushButton::clicked, this, &MainWindow::addProverb);
+
+    editButton = new QPushButton("Edit");
+    connect(editButton, &QPushButton::clicked, this, &MainWindow::editProverb);
+
+    deleteButton = new QPushButton("Delete");
+    connect(deleteButton, &QPushButton::clicked, this, &MainWindow::deleteProverb);
+
+    buttonLayout->addWidget(addButton);
+    buttonLayout->addWidget(editButton);
+    buttonLayout->addWidget(deleteButton);
+
+    leftLayout->addLayout(buttonLayout);
+
+    // Right panel setup
+    rightPanel = new QWidget();
+    rightLayout = new QVBoxLayout(rightPanel);
+
+    proverbDisplay = new QLabel("");
+    proverbDisplay->setWordWrap(true);
+    proverbDisplay->setAlignment(Qt::AlignCenter);
+    proverbDisplay->setStyleSheet(
+        "font-size: 24px;"
+        "color: #4b0082;"
+        "margin: 10px;"
+        "padding: 15px;"
+        "background-color: #f0f0f0;"
+        "border-radius: 10px;"
+        );
+
+    transliterationDisplay = new QLabel("");
+    transliterationDisplay->setWordWrap(true);
+    transliterationDisplay->setAlignment(Qt::AlignCenter);
+    transliterationDisplay->setStyleSheet(
+        "font-size: 18px;"
+        "font-style: italic;"
+        "color: #6a5acd;"
+        "margin: 5px;"
+        );
+
+    meaningTitle = new QLabel("Meaning:");
+    meaningTitle->setStyleSheet("font-weight: bold; font-size: 16px;");
+
+    meaningDisplay = new QLabel("");
+    meaningDisplay->setWordWrap(true);
+    meaningDisplay->setStyleSheet(
+        "font-size: 16px;"
+        "padding: 10px;"
+        "background-color: #0000FF;"
+        "border-radius: 8px;"
+        );
+
+    equivalentTitle = new QLabel("English Equivalent:");
+    equivalentTitle->setStyleSheet("font-weight: bold; font-size: 16px;");
+
+    equivalentDisplay = new QLabel("");
+    equivalentDisplay->setWordWrap(true);
+
+    tagsTitle = new QLabel("Tags:");
+    tagsTitle->setStyleSheet("font-weight: bold; font-size: 16px;");
+
+    tagsDisplay = new QLabel("");
+
+    regionTitle = new QLabel("Region:");
+    regionTitle->setStyleSheet("font-weight: bold; font-size: 16px;");
+
+    regionDisplay = new QLabel("");
+
+    contextTitle = new QLabel("Usage Context:");
+    contextTitle->setStyleSheet("font-weight: bold; font-size: 16px;");
+
+    contextDisplay = new QLabel("");
+    contextDisplay->setWordWrap(true);
+
+    // Add all widgets to right layout
+    rightLayout->addWidget(proverbDisplay);
+    rightLayout->addWidget(transliterationDisplay);
+    rightLayout->addWidget(meaningTitle);
+    rightLayout->addWidget(meaningDisplay);
+    rightLayout->addWidget(equivalentTitle);
+    rightLayout->addWidget(equivalentDisplay);
+    rightLayout->addWidget(tagsTitle);
+    rightLayout->addWidget(tagsDisplay);
+    rightLayout->addWidget(regionTitle);
+    rightLayout->addWidget(regionDisplay);
+    rightLayout->addWidget(contextTitle);
+    rightLayout->addWidget(contextDisplay);
+
+    rightLayout->addStretch();
+
+    // Add panels to splitter
+    splitter->addWidget(leftPanel);
+    splitter->addWidget(rightPanel);
+
+    // Set initial splitter sizes
+    splitter->setSizes({300, 600});
+
+    // Add splitter to main layout
+    mainLayout->addWidget(splitter);
+
+    // Set central widget
+    setCentralWidget(centralWidget);
+
+    // Connect filter comboboxes
+    connect(tagFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::applyFilters);
+    connect(regionFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::applyFilters);
+
+    // Latency percentiles in the status bar, refreshed while shown
+    metricsLabel = new QLabel();
+    metricsLabel->setVisible(false);
+    statusBar()->addPermanentWidget(metricsLabel, 1);
+
+    metricsTimer = new QTimer(this);
+    metricsTimer->setInterval(1000);
+    connect(metricsTimer, &QTimer::timeout, this, &MainWindow::updateMetricsOverlay);
+
+    QMenu *toolsMenu = menuBar()->addMenu("Tools");
+    QAction *importAction = toolsMenu->addAction("Import Proverbs...");
+    connect(importAction, &QAction::triggered, this, &MainWindow::importProverbs);
+    QAction *duplicatesAction = toolsMenu->addAction("Find Duplicates...");
+    connect(duplicatesAction, &QAction::triggered, this, &MainWindow::showDuplicateReport);
+    // Signatures are kept for the records in memory, which a database isn't
+    duplicatesAction->setEnabled(!database);
+    if (database) {
+        statusBar()->addPermanentWidget(
+            new QLabel("Database: no search suggestions or duplicate checks"));
+    }
+    toolsMenu->addSeparator();
+
+    importProgress = nullptr;
+    importWatcher = new QFutureWatcher<ProverbImporter::Result>(this);
+    connect(importWatcher, &QFutureWatcher<ProverbImporter::Result>::finished,
+            this, &MainWindow::showImportResult);
+
+    overlayAction = toolsMenu->addAction("Show Performance Overlay");
+    overlayAction->setCheckable(true);
+    connect(overlayAction, &QAction::toggled, this, [this](bool shown) {
+        metricsLabel->setVisible(shown);
+        if (shown) {
+            updateMetricsOverlay();
+            metricsTimer->start();
+        } else {
+            metricsTimer->stop();
+        }
+    });
+    QAction *dumpAction = toolsMenu->addAction("Dump Metrics...");
+    connect(dumpAction, &QAction::triggered, this, &MainWindow::dumpMetrics);
+}
+
+void MainWindow::loadProverbs()
+{
+    FAKRA_TIMED_SCOPE("loadProverbs");
+
+    // The stored collection: every shard's snapshot plus its journaled
+    // edits since the last compaction. A database is only checked for
+    // records, since the list pages from it.
+    QList<Proverb> proverbs;
+    bool found = database ? !database->isEmpty() : backend->load(proverbs);
+    MappedSnapshots details = backend->mappedSnapshots();
+    quint64 nextId = backend->nextId();
+
+    // A collection still in the one file is split into shards once. It is
+    // only read, along with any edits still in its journal, so the file is
+    // left behind untouched and new ids exist only in the new shards.
+    bool migrated = false;
+    if (!found && QFile::exists(legacyFilename)) {
+        ProverbJournal legacy(legacyFilename);
+        migrated = found = legacy.load(proverbs, ProverbJournal::ReadOnly);
+        details = {legacy.mappedSnapshot()};
+        nextId = legacy.nextId();
+    }
+
+    if (!found) {
+        // Add sample data if file doesn't exist
+        Proverb p1;
+        p1.proverb = "जे बाढ़ि अनैत अछि, ओ नौका सेहो अनैत अछि";
+        p1.transliteration = "Je barhi anait achhi, o nauka seho anait achhi";
+        p1.meaning = "With every problem comes a solution";
+        p1.englishEquivalent = "Every cloud has a silver lining";
+        p1.tags = {"hope", "optimism"};
+        p1.region = "Mithila";
+        p1.usageContext = "Used to encourage someone facing difficulties";
+
+        Proverb p2;
+        p2.proverb = "थारी मे भात, हाथ मे लाठी";
+        p2.transliteration = "Thari me bhat, hath me lathi";
+        p2.meaning = "Being prepared for all situations";
+        p2.englishEquivalent = "Better safe than sorry";
+        p2.tags = {"preparation", "caution"};
+        p2.region = "Darbhanga";
+        p2.usageContext = "When advising someone to be cautious while moving forward";
+
+        Proverb p8;
+        p8.proverb = "Ankar nun tel, ankar ghee; hamra tora lagai aa ki?";
+        p8.transliteration = "Ankar nun tel, ankar ghee; hamra tora lagai aa ki?";
+        p8.meaning = "You have your own oil and ghee, do I need to apply it for you?";
+        p8.englishEquivalent = "Mind your own business.";
+        p8.tags = {"self-reliance", "independence"};
+        p8.region = "Mithila";
+        p8.usageContext = "Used to tell someone to handle their own affairs.";
+
+        Proverb p9;
+        p9.proverb = "Aayl pani, gel pani, biche bilyal pani.";
+        p9.transliteration = "Aayl pani, gel pani, biche bilyal pani.";
+        p9.meaning = "Water came, water went, and the cat remained stuck in between.";
+        p9.englishEquivalent = "Caught in the middle.";
+        p9.tags = {"trouble", "confusion"};
+        p9.region = "Mithila";
+        p9.usageContext = "Used when someone is stuck between two opposing forces.";
+
+        Proverb p3;
+        p3.proverb = "Hey labna, tu bhitre rahna.";
+        p3.transliteration = "Hey labna, tu bhitre rahna.";
+        p3.meaning = "Hey foolish one, stay inside.";
+        p3.englishEquivalent = "Better to stay silent than to expose ignorance.";
+        p3.tags = {"ignorance", "wisdom"};
+        p3.region = "Mithila";
+        p3.usageContext = "Used to advise someone to avoid making a fool of themselves.";
+
+        Proverb p4;
+        p4.proverb = "Aaitho khelau, peto nai bharal.";
+        p4.transliteration = "Aaitho khelau, peto nai bharal.";
+        p4.meaning = "I played the game, but my stomach remains empty.";
+        p4.englishEquivalent = "All play and no gain.";
+        p4.tags = {"effort", "reward"};
+        p4.region = "Mithila";
+        p4.usageContext = "Used when efforts don't yield expected results.";
+
+        Proverb p5;
+        p5.proverb = "Du du gam bhoj bhel, kukurak pet bhukhle.";
+        p5.transliteration = "Du du gam bhoj bhel, kukurak pet bhukhle.";
+        p5.meaning = "A feast in two villages, but the dog remains hungry.";
+        p5.englishEquivalent = "Left out despite abundance.";
+        p5.tags = {"exclusion", "injustice"};
+        p5.region = "Mithila";
+        p5.usageContext = "Used when someone is left out despite there being plenty.";
+
+
+        proverbs.append(p1);
+        proverbs.append(p2);
+        proverbs.append(p3);
+        proverbs.append(p4);
+        proverbs.append(p5);
+        proverbs.append(p8);
+        proverbs.append(p9);
+    }
+
+    if (database) {
+        if (!found || migrated) {
+            commitChange(database->appendAll(proverbs));
+        }
+        fillFacetFilter(tagFilter, "All Tags", getAllTags());
+        fillFacetFilter(regionFilter, "All Regions", getAllRegions());
+        return;
+    }
+
+    // Details stay in the mapped snapshots until a row is selected
+    store.reset(proverbs, details);
+    store.skipIdsTo(nextId);
+    store.trackDuplicates(signaturesFilename);
+    if (!found || migrated) {
+        backend->markDirty(store.columns());
+        saveDirty = true;
+        saveProverbs();
+    }
+
+    // Update the filters
+    fillFacetFilter(tagFilter, "All Tags", getAllTags());
+    fillFacetFilter(regionFilter, "All Regions", getAllRegions());
+
+    // Initially every proverb is shown
+    filteredRows = ProverbFilter::allRows(store.size());
+}
+
+void MainWindow::saveProverbs()
+{
+    FAKRA_TIMED_SCOPE("saveProverbs");
+
+    // Edits made while a write runs are picked up once it finishes
+    if (!saveDirty || saveWatcher->isRunning()) {
+        return;
+    }
+
+    saveDirty = false;
+    saveWatcher->setFuture(backend->writeSnapshotAsync(store.columns()));
+}
+
+void MainWindow::showSaveResult()
+{
+    if (!saveWatcher->result()) {
+        QMessageBox::warning(this, "Error", "Could not save proverbs to file.");
+    }
+
+    if (saveDirty && !saveTimer->isActive()) {
+        saveProverbs();
+    }
+}
+
+void MainWindow::importProverbs()
+{
+    if (importWatcher->isRunning()) {
+        return;
+    }
+
+    QString path = QFileDialog::getOpenFileName(this, "Import Proverbs", QString(),
+                                                "Proverb files (*.csv *.tsv *.jsonl);;All files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    ProverbImporter::Format format;
+    if (!ProverbImporter::formatFor(path, &format)) {
+        QMessageBox::warning(this, "Error", "Only .csv, .tsv and .jsonl files can be imported.");
+        return;
+    }
+
+    // Parsing runs on worker threads; the dialog follows it chunk by chunk
+    importProgress = new QProgressDialog("Importing " + QFileInfo(path).fileName() + "...",
+                                         "Cancel", 0, 0, this);
+    importProgress->setWindowModality(Qt::WindowModal);
+    importProgress->setMinimumDuration(500);
+    connect(importProgress, &QProgressDialog::canceled,
+            importWatcher, &QFutureWatcher<ProverbImporter::Result>::cancel);
+    connect(importWatcher, &QFutureWatcher<ProverbImporter::Result>::progressRangeChanged,
+            importProgress, &QProgressDialog::setRange);
+    connect(importWatcher, &QFutureWatcher<ProverbImporter::Result>::progressValueChanged,
+            importProgress, &QProgressDialog::setValue);
+
+    importWatcher->setFuture(QtConcurrent::run(&ProverbImporter::run, path, format,
+                                               store.duplicates()));
+}
+
+void MainWindow::showImportResult()
+{
+    FAKRA_TIMED_SCOPE("showImportResult");
+
+    importProgress->deleteLater();
+    importProgress = nullptr;
+
+    if (importWatcher->isCanceled()) {
+        return;
+    }
+
+    ProverbImporter::Result result = importWatcher->result();
+    int added = int(result.proverbs.size());
+    if (database) {
+        // One transaction for the whole batch
+        commitChange(database->appendAll(result.proverbs));
+    } else {
+        int firstAdded = store.size();
+        store.addAll(result.proverbs);
+
+        // One write of the shards it reached covers the whole batch instead
+        // of a journal record each
+        backend->markDirty(store.columns(), firstAdded);
+        saveDirty = true;
+        saveTimer->stop();
+        saveProverbs();
+    }
+
+    refreshUi();
+    QString message = QString("Imported %1 proverbs, skipped %2.").arg(added).arg(result.rejected);
+    if (result.duplicates > 0) {
+        message += QString(" %1 look like existing ones; see Tools > Find Duplicates.")
+                       .arg(result.duplicates);
+    }
+    statusBar()->showMessage(message, 10000);
+}
+
+void MainWindow::showDuplicateReport()
+{
+    FAKRA_TIMED_SCOPE("showDuplicateReport");
+
+    QList<QList<quint64>> groups = store.duplicates().duplicateGroups();
+    if (groups.isEmpty()) {
+        QMessageBox::information(this, "Find Duplicates", "No near-duplicate proverbs found.");
+        return;
+    }
+
+    // Listing every group of a huge corpus would only stall the text view
+    const int shownGroups = 500;
+    QStringList lines;
+    for (int g = 0; g < groups.size() && g < shownGroups; ++g) {
+        lines.append(QString("Group %1 (%2 proverbs)").arg(g + 1).arg(groups[g].size()));
+        for (quint64 id : groups[g]) {
+            int row = store.rowOf(id);
+            if (row >= 0) {
+                lines.append(QString("    #%1  %2").arg(id).arg(store.at(row).proverb().toString()));
+            }
+        }
+        lines.append(QString());
+    }
+    if (groups.size() > shownGroups) {
+        lines.append(QString("... and %1 more groups").arg(groups.size() - shownGroups));
+    }
+
+    QDialog report(this);
+    report.setWindowTitle(QString("Near-Duplicates (%1 groups)").arg(groups.size()));
+    QVBoxLayout *layout = new QVBoxLayout(&report);
+    QTextEdit *text = new QTextEdit();
+    text->setReadOnly(true);
+    text->setPlainText(lines.join("\n"));
+    layout->addWidget(text);
+    report.resize(600, 500);
+    report.exec();
+}
+
+void MainWindow::commitChange(bool journaled)
+{
+    if (!journaled) {
+        QMessageBox::warning(this, "Error", "Could not save proverbs to file.");
+    }
+
+    // The database has committed the change already
+    if (database) {
+        return;
+    }
+
+    saveDirty = true;
+    saveTimer->start();
+}
+
+void MainWindow::loadProverbList()
+{
+    FAKRA_TIMED_SCOPE("loadProverbList");
+
+    // A database's first page comes from the search worker and is shown
+    // by showFilterResult()
+    if (database) {
+        applyFilters();
+        return;
+    }
+    listModel->setRows(filteredRows);
+
+    // A model reset drops the current row without notifying the details pane
+    clearProverbDisplay();
+}
+
+void MainWindow::showSelectedProverb(int index)
+{
+    FAKRA_TIMED_SCOPE("showSelectedProverb");
+
+    ProverbRef proverb = listModel->proverbAt(index);
+    if (proverb.isNull()) {
+        clearProverbDisplay();
+        return;
+    }
+
+    proverbDisplay->setText(proverb.proverb().toString());
+    transliterationDisplay->setText(proverb.transliteration().toString());
+    meaningDisplay->setText(proverb.meaning().toString());
+    equivalentDisplay->setText(proverb.englishEquivalent().toString());
+    tagsDisplay->setText(proverb.tags().join(", "));
+    regionDisplay->setText(proverb.region().toString());
+    contextDisplay->setText(proverb.usageContext().toString());
+}
+
+void MainWindow::clearProverbDisplay()
+{
+    proverbDisplay->setText("");
+    transliterationDisplay->setText("");
+    meaningDisplay->setText("");
+    equivalentDisplay->setText("");
+    tagsDisplay->setText("");
+    regionDisplay->setText("");
+    contextDisplay->setText("");
+}
+
+ProverbRef MainWindow::selectedProverb() const
+{
+    // A database page holds the record itself
+    if (database) {
+        return listModel->proverbAt(proverbList->currentIndex().row());
+    }
+
+    // Resolve through the id so a stale view row can never hit another record
+    QVariant id = proverbList->currentIndex().data(ProverbListModel::IdRole);
+    int row = id.isValid() ? store.rowOf(id.toULongLong()) : -1;
+    return row >= 0 ? store.at(row) : ProverbRef();
+}
+
+void MainWindow::addProverb()
+{
+    // Near-duplicates are only found among records in memory
+    ProverbDialog dialog(this);
+    if (!database) {
+        dialog.setSaveCheck([this, &dialog](const Proverb &data) {
+            return confirmNotDuplicate(data, 0, &dialog);
+        });
+    }
+
+    if (dialog.exec() == QDialog::Accepted) {
+        Proverb proverb = dialog.getProverbData();
+        if (database) {
+            proverb.id = database->nextId();
+        } else {
+            proverb = store.add(proverb);
+        }
+        commitChange(backend->appendAdd(proverb));
+        refreshUi();
+    }
+}
+
+void MainWindow::editProverb()
+{
+    ProverbRef current = selectedProverb();
+    if (current.isNull()) {
+        QMessageBox::warning(this, "Warning", "Please select a proverb to edit.");
+        return;
+    }
+
+    ProverbDialog dialog(this, current);
+
+    // Only a change to the compared text can make the record a new
+    // duplicate; a neighbour it already had was accepted before
+    quint64 id = current.id();
+    QString text = current.proverb().toString();
+    QString transliteration = current.transliteration().toString();
+    if (!database) {
+        dialog.setSaveCheck([this, &dialog, id, text, transliteration](const Proverb &data) {
+            if (data.proverb == text && data.transliteration == transliteration) {
+                return true;
+            }
+            return confirmNotDuplicate(data, id, &dialog);
+        });
+    }
+
+    if (dialog.exec() == QDialog::Accepted) {
+        // The ref may be gone by now; the id still finds the record
+        Proverb proverb = dialog.getProverbData();
+        if (database) {
+            proverb.id = id;
+        } else {
+            proverb = store.edit(store.rowOf(id), proverb);
+        }
+        commitChange(backend->appendEdit(proverb));
+
+        refreshUi();
+    }
+}
+
+bool MainWindow::confirmNotDuplicate(const Proverb &proverb, quint64 ownId, QWidget *parent)
+{
+    FAKRA_TIMED_SCOPE("duplicateCheck");
+
+    QList<DuplicateIndex::Match> matches = store.duplicates().candidates(
+        DuplicateIndex::signature(proverb.proverb, proverb.transliteration), ownId);
+    if (matches.isEmpty()) {
+        return true;
+    }
+
+    QStringList similar;
+    for (int i = 0; i < matches.size() && i < 3; ++i) {
+        int row = store.rowOf(matches[i].id);
+        if (row >= 0) {
+            similar.append(QString("%1 (%2% similar)")
+                               .arg(store.at(row).proverb().toString())
+                               .arg(qRound(matches[i].similarity * 100)));
+        }
+    }
+
+    QMessageBox::StandardButton answer = QMessageBox::question(
+        parent, "Possible Duplicate",
+        "This proverb looks like one already in the collection:\n\n" + similar.join("\n") +
+            "\n\nSave it anyway?",
+        QMessageBox::Yes | QMessageBox::No
+        );
+    return answer == QMessageBox::Yes;
+}
+
+void MainWindow::deleteProverb()
+{
+    ProverbRef current = selectedProverb();
+    if (current.isNull()) {
+        QMessageBox::warning(this, "Warning", "Please select a proverb to delete.");
+        return;
+    }
+    quint64 id = current.id();
+
+    QMessageBox::StandardButton confirmation = QMessageBox::question(
+        this, "Confirm Deletion",
+        "Are you sure you want to delete this proverb?",
+        QMessageBox::Yes | QMessageBox::No
+        );
+
+    if (confirmation == QMessageBox::Yes) {
+        if (!database) {
+            store.remove(store.rowOf(id));
+        }
+        commitChange(backend->appendRemove(id));
+
+        refreshUi();
+    }
+}
+
+void MainWindow::searchProverbs()
+{
+    searchTimer->start();
+}
+
+ProverbFilter MainWindow::currentFilter() const
+{
+    ProverbFilter filter;
+    filter.searchText = ProverbIndex::normalize(searchInput->text());
+    filter.ranked = rankedSearch->isChecked();
+
+    // Items carry the bare term as data; "All" entries carry none
+    filter.tag = tagFilter->currentData().toString();
+    filter.region = regionFilter->currentData().toString();
+
+    return filter;
+}
+
+void MainWindow::applyFilters()
+{
+    FAKRA_TIMED_SCOPE("applyFilters");
+
+    searchTimer->stop();
+
+    // Bumping the generation makes any query still running abandon itself
+    quint64 generation = searchGeneration.fetchAndAddOrdered(1) + 1;
+    ProverbFilter filter = currentFilter();
+    watchedFilter = filter;
+
+    // The database counts and reads the first page on the worker, through
+    // a connection of the worker's own; a superseded page is dropped
+    if (database) {
+        QString path = databaseFilename;
+        watchedGeneration = generation;
+        searchWatcher->setFuture(QtConcurrent::run([filter, path]() {
+            FAKRA_TIMED_SCOPE("filterQuery");
+            ProverbDatabase::Page page = ProverbDatabase::forThisThread(path)->query(
+                filter, 0, ProverbListModel::PageSize);
+            FilterResult result;
+            result.records = page.proverbs;
+            result.total = page.total;
+            return result;
+        }));
+        return;
+    }
+
+    // Implicitly shared copies: later edits detach instead of racing the worker
+    ProverbStore snapshot = store;
+    QAtomicInteger<quint64> *current = &searchGeneration;
+    QueryCache *cache = &queryCache;
+
+    watchedGeneration = generation;
+    searchWatcher->setFuture(QtConcurrent::run([filter, snapshot, current, cache, generation]() {
+        FAKRA_TIMED_SCOPE("filterQuery");
+        return cache->query(snapshot, filter, [current, generation]() {
+            return current->loadRelaxed() != generation;
+        });
+    }));
+}
+
+void MainWindow::applyFiltersNow()
+{
+    FAKRA_TIMED_SCOPE("applyFilters");
+
+    // Used after edits, where stale rows would point at shifted records.
+    // Database rows are records rather than indices, so they can wait.
+    if (database) {
+        applyFilters();
+        return;
+    }
+    searchTimer->stop();
+    searchGeneration.fetchAndAddOrdered(1);
+
+    showFilterResult(queryCache.query(store, currentFilter()));
+}
+
+void MainWindow::showSearchResults()
+{
+    // Results of a superseded query are dropped
+    if (!searchWatcher->isFinished() || watchedGeneration != searchGeneration.loadRelaxed()) {
+        return;
+    }
+
+    showFilterResult(searchWatcher->result());
+}
+
+void MainWindow::showFilterResult(const FilterResult &result)
+{
+    // Facet counts are only kept for the records in memory
+    if (database) {
+        listModel->setQuery(watchedFilter, result.records, result.total);
+        clearProverbDisplay();
+        return;
+    }
+
+    filteredRows = result.rows;
+    showFacetCounts(tagFilter, store.columns().tagTerms(), result.tagCounts);
+    showFacetCounts(regionFilter, store.facets().regions(), result.regionCounts);
+    loadProverbList();
+}
+
+void MainWindow::fillFacetFilter(QComboBox *combo, const QString &allLabel, const QStringList &terms)
+{
+    combo->clear();
+    combo->addItem(allLabel);
+    for (const QString &term : terms) {
+        combo->addItem(term, term);
+    }
+}
+
+void MainWindow::showFacetCounts(QComboBox *combo, const TermDictionary &terms, const QVector<int> &counts)
+{
+    // Relabelling items leaves the current selection untouched
+    for (int i = 1; i < combo->count(); ++i) {
+        QString term = combo->itemData(i).toString();
+        int id = terms.find(term);
+        int count = id >= 0 && id < counts.size() ? counts[id] : 0;
+        combo->setItemText(i, QString("%1 (%2)").arg(term).arg(count));
+    }
+}
+
+QStringList MainWindow::getAllTags() const
+{
+    return database ? database->tags() : store.columns().tagTerms().sortedTerms();
+}
+
+QStringList MainWindow::getAllRegions() const
+{
+    return database ? database->regions() : store.facets().regions().sortedTerms();
+}
+
+void MainWindow::refreshUi()
+{
+    // Save current filter selections
+    QString currentTag = tagFilter->currentData().toString();
+    QString currentRegion = regionFilter->currentData().toString();
+
+    // Update filters
+    fillFacetFilter(tagFilter, "All Tags", getAllTags());
+    fillFacetFilter(regionFilter, "All Regions", getAllRegions());
+
+    // Restore previous selections
+    int tagIndex = tagFilter->findData(currentTag);
+    tagFilter->setCurrentIndex(tagIndex >= 0 ? tagIndex : 0);
+
+    int regionIndex = regionFilter->findData(currentRegion);
+    regionFilter->setCurrentIndex(regionIndex >= 0 ? regionIndex : 0);
+
+    // Apply filters to refresh the list
+    applyFiltersNow();
+}
+
+// ProverbDialog implementation
+ProverbDialog::ProverbDialog(QWidget *parent, ProverbRef proverbData)
+    : QDialog(parent)
+{
+    setWindowTitle(!proverbData.isNull() ? "Edit Proverb" : "Add New Proverb");
+    setMinimumWidth(500);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    QFormLayout *formLayout = new QFormLayout();
+
+    proverbEdit = new QTextEdit();
+    proverbEdit->setPlaceholderText("Enter proverb in Maithili");
+
+    transliterationEdit = new QTextEdit();
+    transliterationEdit->setPlaceholderText("Enter transliteration");
+
+    meaningEdit = new QTextEdit();
+    meaningEdit->setPlaceholderText("Enter meaning");
+
+    equivalentEdit = new QTextEdit();
+    equivalentEdit->setPlaceholderText("English equivalent (if any)");
+
+    tagsEdit = new QLineEdit();
+    tagsEdit->setPlaceholderText("Enter tags separated by commas");
+
+    regionEdit = new QLineEdit();
+    regionEdit->setPlaceholderText("Region of origin");
+
+    contextEdit = new QTextEdit();
+    contextEdit->setPlaceholderText("When/how is this proverb typically used?");
+
+    // Populate fields if editing
+    if (!proverbData.isNull()) {
+        proverbEdit->setText(proverbData.proverb().toString());
+        transliterationEdit->setText(proverbData.transliteration().toString());
+        meaningEdit->setText(proverbData.meaning().toString());
+        equivalentEdit->setText(proverbData.englishEquivalent().toString());
+        tagsEdit->setText(proverbData.tags().join(", "));
+        regionEdit->setText(proverbData.region().toString());
+        contextEdit->setText(proverbData.usageContext().toString());
+    }
+
+    formLayout->addRow("Proverb:", proverbEdit);
+    formLayout->addRow("Transliteration:", transliterationEdit);
+    formLayout->addRow("Meaning:", meaningEdit);
+    formLayout->addRow("English Equivalent:", equivalentEdit);
+    formLayout->addRow("Tags:", tagsEdit);
+    formLayout->addRow("Region:", regionEdit);
+    formLayout->addRow("Usage Context:", contextEdit);
+
+    layout->addLayout(formLayout);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    QPushButton *saveButton = new QPushButton("Save");
+    connect(saveButton, &QPushButton::clicked, this, &QDialog::accept);
+
+    QPushButton *cancelButton = new QPushButton("Cancel");
+    connect(cancelButton, &QPushButton::clicked, this, &QDialog::reject);
+
+    buttonLayout->addWidget(saveButton);
+    buttonLayout->addWidget(cancelButton);
+
+    layout->addLayout(buttonLayout);
+}
+
+void ProverbDialog::setSaveCheck(const SaveCheck &check)
+{
+    saveCheck = check;
+}
+
+void ProverbDialog::accept()
+{
+    if (saveCheck && !saveCheck(getProverbData())) {
+        return;
+    }
+    QDialog::accept();
+}
+
+Proverb ProverbDialog::getProverbData() const
+{
+    Proverb p;
+    p.proverb = proverbEdit->toPlainText();
+    p.transliteration = transliterationEdit->toPlainText();
+    p.meaning = meaningEdit->toPlainText();
+    p.englishEquivalent = equivalentEdit->toPlainText();
+
+    p.tags = Proverb::splitTags(tagsEdit->text());
+
+    p.region = regionEdit->text();
+    p.usageContext = contextEdit->toPlainText();
+
+    return p;
+}
+
+void MainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+
+    // Startup ends once the window has been drawn for the first time
+    if (!painted) {
+        painted = true;
+        Metrics::instance().markStartupEnd();
+    }
+}
+
+void MainWindow::updateMetricsOverlay()
+{
+    static const char *const scopes[] = {
+        "applyFilters", "filterQuery", "loadProverbList", "showSelectedProverb"
+    };
+
+    QStringList parts;
+    for (const char *scope : scopes) {
+        const LatencyHistogram &h = Metrics::instance().histogram(scope);
+        parts.append(QString("%1 %2/%3/%4 ms")
+                         .arg(scope)
+                         .arg(h.percentile(0.50) / 1e6, 0, 'f', 2)
+                         .arg(h.percentile(0.95) / 1e6, 0, 'f', 2)
+                         .arg(h.percentile(0.99) / 1e6, 0, 'f', 2));
+    }
+    metricsLabel->setText("p50/p95/p99: " + parts.join("  |  "));
+}
+
+void MainWindow::dumpMetrics()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Dump Metrics", "fakra-metrics.json",
+                                                "JSON files (*.json)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    // The trace, if enabled, is flushed too so a slow session can be
+    // captured without quitting
+    if (!Metrics::instance().writeJson(path) || !Metrics::instance().writeTrace()) {
+        QMessageBox::warning(this, "Error", "Could not write metrics.");
+    }
+}
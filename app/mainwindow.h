@@ -0,0 +1,191 @@
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include <QAction>
+#include <QAtomicInteger>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QCompleter>
+#include <QDialog>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFormLayout>
+#include <QFutureWatcher>
+#include <QHBoxLayout>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+#include <QMainWindow>
+#include <QMenuBar>
+#include <QMessageBox>
+#include <QPaintEvent>
+#include <QProgressDialog>
+#include <QPushButton>
+#include <QScopedPointer>
+#include <QSplitter>
+#include <QStatusBar>
+#include <QTextEdit>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include <functional>
+
+#include "completionmodel.h"
+#include "metrics.h"
+#include "proverb.h"
+#include "proverbbackend.h"
+#include "proverbcollection.h"
+#include "proverbdatabase.h"
+#include "proverbimporter.h"
+#include "proverbjournal.h"
+#include "proverblistmodel.h"
+#include "proverbstore.h"
+#include "querycache.h"
+
+// Dialog for adding/editing proverbs
+class ProverbDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    // Asked on Save with what was entered; returning false keeps the
+    // dialog open with everything still in it
+    typedef std::function<bool(const Proverb &)> SaveCheck;
+
+    ProverbDialog(QWidget *parent = nullptr, ProverbRef proverbData = ProverbRef());
+    Proverb getProverbData() const;
+    void setSaveCheck(const SaveCheck &check);
+
+public slots:
+    void accept() override;
+
+private:
+    SaveCheck saveCheck;
+    QTextEdit *proverbEdit;
+    QTextEdit *transliterationEdit;
+    QTextEdit *meaningEdit;
+    QTextEdit *equivalentEdit;
+    QLineEdit *tagsEdit;
+    QLineEdit *regionEdit;
+    QTextEdit *contextEdit;
+};
+
+class MainWindow : public QMainWindow {
+    Q_OBJECT
+
+public:
+    MainWindow(QWidget *parent = nullptr);
+    ~MainWindow();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private slots:
+    void showSelectedProverb(int index);
+    void addProverb();
+    void editProverb();
+    void deleteProverb();
+    void searchProverbs();
+    void applyFilters();
+    void showSearchResults();
+    void saveProverbs();
+    void showSaveResult();
+    void importProverbs();
+    void showImportResult();
+    void showDuplicateReport();
+    void dumpMetrics();
+    void updateMetricsOverlay();
+
+private:
+    // UI Elements
+    QWidget *centralWidget;
+    QSplitter *splitter;
+    QWidget *leftPanel;
+    QWidget *rightPanel;
+    QVBoxLayout *leftLayout;
+    QVBoxLayout *rightLayout;
+    QHBoxLayout *searchLayout;
+    QHBoxLayout *filterLayout;
+    QHBoxLayout *buttonLayout;
+    QLineEdit *searchInput;
+    CompletionModel *completionModel;
+    QCheckBox *rankedSearch;
+    QComboBox *tagFilter;
+    QComboBox *regionFilter;
+    QListView *proverbList;
+    ProverbListModel *listModel;
+    QPushButton *addButton;
+    QPushButton *editButton;
+    QPushButton *deleteButton;
+
+    // Performance overlay
+    QAction *overlayAction;
+    QLabel *metricsLabel;
+    QTimer *metricsTimer;
+    bool painted;
+
+    // Background search
+    QTimer *searchTimer;
+    QFutureWatcher<FilterResult> *searchWatcher;
+    QAtomicInteger<quint64> searchGeneration;
+    quint64 watchedGeneration;
+    ProverbFilter watchedFilter;    // the query of watchedGeneration
+    QueryCache queryCache;
+
+    // Proverb display elements
+    QLabel *proverbDisplay;
+    QLabel *transliterationDisplay;
+    QLabel *meaningTitle;
+    QLabel *meaningDisplay;
+    QLabel *equivalentTitle;
+    QLabel *equivalentDisplay;
+    QLabel *tagsTitle;
+    QLabel *tagsDisplay;
+    QLabel *regionTitle;
+    QLabel *regionDisplay;
+    QLabel *contextTitle;
+    QLabel *contextDisplay;
+
+    // Background autosave
+    QTimer *saveTimer;
+    QFutureWatcher<bool> *saveWatcher;
+    bool saveDirty;     // edits not yet in a snapshot write
+
+    // Bulk import
+    QFutureWatcher<ProverbImporter::Result> *importWatcher;
+    QProgressDialog *importProgress;
+
+    // Data
+    ProverbStore store;
+    QVector<int> filteredRows;
+    QString legacyFilename;     // single-file collection from before sharding
+    QString collectionPath;
+    QString databaseFilename;   // used instead of collectionPath when present
+    QString signaturesFilename;
+    QScopedPointer<ProverbBackend> backend;
+    // The backend when it is a database; the list then pages from it and
+    // the store stays empty
+    ProverbDatabase *database;
+
+    // Methods
+    void setupUi();
+    void loadProverbs();
+    bool confirmNotDuplicate(const Proverb &proverb, quint64 ownId, QWidget *parent);
+    void commitChange(bool journaled);
+    void refreshUi();
+    void loadProverbList();
+    void clearProverbDisplay();
+    ProverbRef selectedProverb() const;
+    QStringList getAllTags() const;
+    QStringList getAllRegions() const;
+    ProverbFilter currentFilter() const;
+    void applyFiltersNow();
+    void showFilterResult(const FilterResult &result);
+    void fillFacetFilter(QComboBox *combo, const QString &allLabel, const QStringList &terms);
+    void showFacetCounts(QComboBox *combo, const TermDictionary &terms, const QVector<int> &counts);
+};
+
+#endif // MAINWINDOW_H
@@ -0,0 +1,129 @@
+#include "proverblistmodel.h"
+
+#include <QtConcurrent>
+
+ProverbListModel::ProverbListModel(const ProverbColumns *proverbs, QObject *parent)
+    : QAbstractListModel(parent),
+    proverbs(proverbs)
+{
+}
+
+ProverbListModel::ProverbListModel(const QString &databasePath, QObject *parent)
+    : QAbstractListModel(parent),
+    databasePath(databasePath),
+    pageWatcher(new QFutureWatcher<ProverbDatabase::Page>(this))
+{
+    connect(pageWatcher, &QFutureWatcher<ProverbDatabase::Page>::finished, this, &ProverbListModel::insertPage);
+}
+
+int ProverbListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return !databasePath.isEmpty() ? fetched.size() : rows.size();
+}
+
+QVariant ProverbListModel::data(const QModelIndex &index, int role) const
+{
+    ProverbRef proverb = proverbAt(index.row());
+    if (!index.isValid() || proverb.isNull()) {
+        return QVariant();
+    }
+
+    if (role == Qt::DisplayRole) {
+        return proverb.proverb().toString();
+    }
+    if (role == IdRole) {
+        return proverb.id();
+    }
+
+    return QVariant();
+}
+
+bool ProverbListModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !databasePath.isEmpty() && !fetching && fetched.size() < total;
+}
+
+void ProverbListModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    // The GUI thread never waits on SQLite; the page is inserted once it
+    // arrives, unless setQuery() replaced the query meanwhile
+    fetching = true;
+    fetchGeneration = queryGeneration;
+    QString path = databasePath;
+    ProverbFilter query = filter;
+    int offset = fetched.size();
+    pageWatcher->setFuture(QtConcurrent::run([path, query, offset]() {
+        return ProverbDatabase::forThisThread(path)->query(query, offset, PageSize);
+    }));
+}
+
+void ProverbListModel::insertPage()
+{
+    fetching = false;
+    if (fetchGeneration != queryGeneration) {
+        return;
+    }
+
+    ProverbDatabase::Page page = pageWatcher->result();
+    if (page.proverbs.isEmpty()) {
+        // Records went since the count; there is nothing further to show
+        total = fetched.size();
+        return;
+    }
+
+    int first = fetched.size();
+    beginInsertRows(QModelIndex(), first, first + int(page.proverbs.size()) - 1);
+    for (const Proverb &proverb : page.proverbs) {
+        fetched.append(proverb);
+    }
+    endInsertRows();
+}
+
+void ProverbListModel::setRows(const QVector<int> &newRows)
+{
+    beginResetModel();
+    rows = newRows;
+    endResetModel();
+}
+
+void ProverbListModel::setQuery(const ProverbFilter &newFilter, const QList<Proverb> &firstPage, int newTotal)
+{
+    beginResetModel();
+    ++queryGeneration;
+    fetching = false;
+    filter = newFilter;
+    total = newTotal;
+    fetched.clear();
+    for (const Proverb &proverb : firstPage) {
+        fetched.append(proverb);
+    }
+    endResetModel();
+}
+
+int ProverbListModel::sourceRow(int row) const
+{
+    if (!databasePath.isEmpty() || row < 0 || row >= rows.size()) {
+        return -1;
+    }
+
+    // The collection can shrink before the next reset reaches the view
+    int source = rows[row];
+    return source < proverbs->size() ? source : -1;
+}
+
+ProverbRef ProverbListModel::proverbAt(int row) const
+{
+    if (!databasePath.isEmpty()) {
+        return row >= 0 && row < fetched.size() ? fetched.ref(row) : ProverbRef();
+    }
+
+    int source = sourceRow(row);
+    return source >= 0 ? proverbs->ref(source) : ProverbRef();
+}
@@ -0,0 +1,69 @@
+#ifndef PROVERBLISTMODEL_H
+#define PROVERBLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QFutureWatcher>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "proverbcolumns.h"
+#include "proverbdatabase.h"
+#include "proverbfilter.h"
+
+// List model presenting a subset of the collection by row index, so the
+// view only realizes the rows that are actually visible. Over a database
+// it presents a query instead, fetching its matches a page at a time as
+// the view scrolls, so only the pages seen so far are held. Pages are read
+// on a worker thread with its own connection and inserted once they
+// arrive; the first page comes with the query from the caller.
+class ProverbListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        IdRole = Qt::UserRole   // stable Proverb::id of the row
+    };
+
+    // Rows fetched from the database per page
+    static const int PageSize = 200;
+
+    explicit ProverbListModel(const ProverbColumns *proverbs, QObject *parent = nullptr);
+    // Pages from the database at databasePath
+    explicit ProverbListModel(const QString &databasePath, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    // Replaces the visible rows (indices into the collection) with one reset
+    void setRows(const QVector<int> &rows);
+    // Replaces the database query with one reset, showing firstPage of its
+    // total matches; later pages are fetched as the view scrolls
+    void setQuery(const ProverbFilter &filter, const QList<Proverb> &firstPage, int total);
+
+    // Maps a view row back to its index in the collection, or -1
+    int sourceRow(int row) const;
+    // The record shown in a view row, or a null ref; valid until the
+    // model next changes
+    ProverbRef proverbAt(int row) const;
+
+private:
+    void insertPage();
+
+    const ProverbColumns *proverbs = nullptr;
+    QVector<int> rows;
+
+    QString databasePath;       // empty unless paging from a database
+    ProverbFilter filter;
+    ProverbColumns fetched;     // the query's matches paged in so far
+    int total = 0;              // matches of the query
+    QFutureWatcher<ProverbDatabase::Page> *pageWatcher = nullptr;
+    bool fetching = false;      // a page is on its way
+    quint64 queryGeneration = 0;    // bumped by setQuery()
+    quint64 fetchGeneration = 0;    // the query the page on its way is for
+};
+
+#endif // PROVERBLISTMODEL_H
@@ -0,0 +1,11 @@
+QT = core concurrent testlib sql
+
+TARGET = fakra-bench
+TEMPLATE = app
+CONFIG += console testcase benchmark
+CONFIG -= app_bundle
+
+include(../core/fakra_core.pri)
+
+SOURCES += corpusgenerator.cpp fakrabenchmark.cpp
+HEADERS += corpusgenerator.h
@@ -0,0 +1,156 @@
+#include "corpusgenerator.h"
+
+#include <algorithm>
+
+namespace {
+struct Syllable {
+    const char *devanagari;
+    const char *latin;
+};
+
+const Syllable Syllables[] = {
+    {"क", "ka"}, {"का", "kaa"}, {"कि", "ki"}, {"खे", "khe"}, {"गा", "gaa"}, {"घर", "ghar"},
+    {"च", "cha"}, {"छि", "chhi"}, {"जा", "jaa"}, {"झ", "jha"}, {"ट", "ta"}, {"ठा", "thaa"},
+    {"ड़ि", "ri"}, {"ढ़", "rha"}, {"त", "ta"}, {"था", "thaa"}, {"दि", "di"}, {"धा", "dhaa"},
+    {"न", "na"}, {"नौ", "nau"}, {"प", "pa"}, {"पा", "paa"}, {"फ", "pha"}, {"ब", "ba"},
+    {"बा", "baa"}, {"भा", "bhaa"}, {"म", "ma"}, {"मे", "me"}, {"य", "ya"}, {"र", "ra"},
+    {"री", "ri"}, {"ल", "la"}, {"ला", "laa"}, {"व", "va"}, {"स", "sa"}, {"सै", "sai"},
+    {"ह", "ha"}, {"हो", "ho"}, {"अ", "a"}, {"ओ", "o"}, {"ऐ", "ai"}, {"इ", "i"}
+};
+
+const char *const EnglishWords[] = {
+    "water", "river", "village", "feast", "dog", "cat", "boat", "rice", "field", "rain",
+    "flood", "house", "guest", "neighbour", "elder", "child", "market", "gold", "salt", "oil",
+    "work", "patience", "fool", "wise", "hungry", "quiet", "proud", "trouble", "luck", "road",
+    "moon", "cloud", "mango", "buffalo", "well", "cow", "stick", "plate", "king", "thief"
+};
+
+const char *const Tags[] = {
+    "wisdom", "patience", "family", "hope", "caution", "pride", "greed", "friendship",
+    "hard work", "fate", "humour", "food", "village life", "honesty", "foolishness",
+    "money", "hospitality", "marriage", "elders", "trust", "injustice", "nature",
+    "weather", "agriculture", "self-reliance", "unity", "deceit", "knowledge", "health",
+    "time", "speech", "anger", "contentment", "charity", "courage", "laziness",
+    "ambition", "hypocrisy", "respect", "karma", "river", "festival", "education",
+    "poverty", "wealth", "neighbours", "gossip", "loyalty"
+};
+
+const char *const Regions[] = {
+    "Mithila", "Darbhanga", "Madhubani", "Sitamarhi", "Saharsa", "Supaul", "Purnia",
+    "Samastipur", "Muzaffarpur", "Begusarai", "Katihar", "Janakpur", "Siraha", "Saptari"
+};
+
+QStringList vocabulary(const char *const *words, int count)
+{
+    QStringList list;
+    for (int i = 0; i < count; ++i) {
+        list.append(QString::fromUtf8(words[i]));
+    }
+    return list;
+}
+}
+
+CorpusGenerator::CorpusGenerator(quint32 seed)
+    : random(seed),
+    tagWeights(zipfTable(tagVocabulary().size())),
+    regionWeights(zipfTable(regionVocabulary().size()))
+{
+}
+
+QList<Proverb> CorpusGenerator::generate(int count)
+{
+    QList<Proverb> proverbs;
+    proverbs.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        proverbs.append(next());
+    }
+    return proverbs;
+}
+
+Proverb CorpusGenerator::next()
+{
+    const int syllableCount = int(sizeof(Syllables) / sizeof(Syllables[0]));
+    const int englishCount = int(sizeof(EnglishWords) / sizeof(EnglishWords[0]));
+
+    Proverb p;
+
+    // Four to eight words in two clauses, each word two or three syllables
+    QStringList devanagari;
+    QStringList latin;
+    int words = 4 + random.bounded(5);
+    for (int w = 0; w < words; ++w) {
+        QString dWord;
+        QString lWord;
+        int syllables = 2 + random.bounded(2);
+        for (int s = 0; s < syllables; ++s) {
+            const Syllable &syllable = Syllables[random.bounded(syllableCount)];
+            dWord += QString::fromUtf8(syllable.devanagari);
+            lWord += QString::fromUtf8(syllable.latin);
+        }
+        if (w == words / 2 - 1) {
+            dWord += ',';
+            lWord += ',';
+        }
+        devanagari.append(dWord);
+        latin.append(lWord);
+    }
+    latin.first()[0] = latin.first()[0].toUpper();
+    p.proverb = devanagari.join(' ');
+    p.transliteration = latin.join(' ');
+
+    auto sentence = [this, englishCount](int minWords, int maxWords) {
+        QStringList text;
+        int count = minWords + random.bounded(maxWords - minWords + 1);
+        for (int i = 0; i < count; ++i) {
+            text.append(QString::fromUtf8(EnglishWords[random.bounded(englishCount)]));
+        }
+        QString result = text.join(' ') + '.';
+        result[0] = result[0].toUpper();
+        return result;
+    };
+    p.meaning = sentence(6, 14);
+    p.englishEquivalent = sentence(3, 7);
+    p.usageContext = "Used when " + sentence(5, 10).toLower();
+
+    // One to three distinct tags
+    int tagCount = 1 + random.bounded(3);
+    while (p.tags.size() < tagCount) {
+        QString tag = tagVocabulary()[zipf(tagWeights)];
+        if (!p.tags.contains(tag)) {
+            p.tags.append(tag);
+        }
+    }
+    p.region = regionVocabulary()[zipf(regionWeights)];
+
+    return p;
+}
+
+const QStringList &CorpusGenerator::tagVocabulary()
+{
+    static const QStringList tags = vocabulary(Tags, int(sizeof(Tags) / sizeof(Tags[0])));
+    return tags;
+}
+
+const QStringList &CorpusGenerator::regionVocabulary()
+{
+    static const QStringList regions = vocabulary(Regions, int(sizeof(Regions) / sizeof(Regions[0])));
+    return regions;
+}
+
+int CorpusGenerator::zipf(const QVector<double> &cumulative)
+{
+    double pick = random.generateDouble() * cumulative.last();
+    auto it = std::upper_bound(cumulative.begin(), cumulative.end(), pick);
+    return qMin(int(it - cumulative.begin()), int(cumulative.size()) - 1);
+}
+
+QVector<double> CorpusGenerator::zipfTable(int size)
+{
+    QVector<double> cumulative(size);
+    double total = 0.0;
+    for (int rank = 0; rank < size; ++rank) {
+        total += 1.0 / (rank + 1);
+        cumulative[rank] = total;
+    }
+    return cumulative;
+}
@@ -0,0 +1,36 @@
+#ifndef CORPUSGENERATOR_H
+#define CORPUSGENERATOR_H
+
+#include <QList>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QVector>
+
+#include "proverb.h"
+
+// Deterministic synthetic proverbs for benchmarks. Text is built from
+// Devanagari syllables paired with their romanization, so the proverb
+// and transliteration fields agree. Tags and regions follow a Zipf
+// distribution, so a few terms are common and the rest are rare.
+// The same seed always yields the same corpus.
+class CorpusGenerator {
+public:
+    explicit CorpusGenerator(quint32 seed = 20240601);
+
+    QList<Proverb> generate(int count);
+    Proverb next();
+
+    static const QStringList &tagVocabulary();
+    static const QStringList &regionVocabulary();
+
+private:
+    // Index in [0, cumulative.size()) drawn with weight 1 / (rank + 1)
+    int zipf(const QVector<double> &cumulative);
+    static QVector<double> zipfTable(int size);
+
+    QRandomGenerator random;
+    QVector<double> tagWeights;
+    QVector<double> regionWeights;
+};
+
+#endif // CORPUSGENERATOR_H
@@ -0,0 +1,484 @@
+#include <QHash>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "corpusgenerator.h"
+#include "proverbcollection.h"
+#include "proverbdatabase.h"
+#include "proverbjournal.h"
+#include "proverbstore.h"
+#include "querycache.h"
+
+// Load, save, search, filter, facet, duplicate, completion and edit benchmarks at
+// 10k, 100k and 1M records, loading both single-file and sharded collections.
+// Results are machine readable with QtTest's own formats, e.g.
+//   fakra-bench -o results.csv,csv
+//   fakra-bench -o results.xml,xml
+// FAKRA_BENCH_MAX_RECORDS caps the largest corpus for quicker runs.
+class FakraBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void load_data();
+    void load();
+    void loadSharded_data();
+    void loadSharded();
+    void save_data();
+    void save();
+    void search_data();
+    void search();
+    void searchLegacyScan_data();
+    void searchLegacyScan();
+    void databaseQuery_data();
+    void databaseQuery();
+    void typeAhead_data();
+    void typeAhead();
+    void applyFilters_data();
+    void applyFilters();
+    void facetTerms_data();
+    void facetTerms();
+    void duplicateCheck_data();
+    void duplicateCheck();
+    void complete_data();
+    void complete();
+    void editWhileSnapshotted_data();
+    void editWhileSnapshotted();
+
+private:
+    static QList<int> scales();
+    void addScales();
+    void addQueries();
+    const QList<Proverb> &corpus(int records);
+    const ProverbStore &store(int records);
+    QString snapshotPath(int records);
+
+    QTemporaryDir dir;
+    QHash<int, QList<Proverb>> corpora;
+    QHash<int, ProverbStore> stores;
+};
+
+void FakraBenchmark::initTestCase()
+{
+    QVERIFY(dir.isValid());
+}
+
+QList<int> FakraBenchmark::scales()
+{
+    int limit = qEnvironmentVariableIsSet("FAKRA_BENCH_MAX_RECORDS")
+                    ? qEnvironmentVariableIntValue("FAKRA_BENCH_MAX_RECORDS")
+                    : 1000000;
+
+    QList<int> result;
+    for (int records : {10000, 100000, 1000000}) {
+        if (records <= limit) {
+            result.append(records);
+        }
+    }
+    return result;
+}
+
+void FakraBenchmark::addScales()
+{
+    QTest::addColumn<int>("records");
+
+    for (int records : scales()) {
+        QTest::newRow(qPrintable(QString::number(records))) << records;
+    }
+}
+
+void FakraBenchmark::addQueries()
+{
+    QTest::addColumn<int>("records");
+    QTest::addColumn<QString>("query");
+
+    // A short query takes the linear scan, longer ones the trigram index,
+    // and the romanized one also exercises the phonetic keys
+    const QStringList queries = {"ka", "water", "river village", "bhaa"};
+    for (int records : scales()) {
+        for (const QString &query : queries) {
+            QTest::newRow(qPrintable(QString("%1/%2").arg(records).arg(query))) << records << query;
+        }
+    }
+}
+
+const QList<Proverb> &FakraBenchmark::corpus(int records)
+{
+    // Generated once per scale and shared by every benchmark
+    auto it = corpora.find(records);
+    if (it == corpora.end()) {
+        CorpusGenerator generator;
+        it = corpora.insert(records, generator.generate(records));
+    }
+    return it.value();
+}
+
+const ProverbStore &FakraBenchmark::store(int records)
+{
+    auto it = stores.find(records);
+    if (it == stores.end()) {
+        it = stores.insert(records, ProverbStore());
+        it.value().reset(corpus(records));
+    }
+    return it.value();
+}
+
+QString FakraBenchmark::snapshotPath(int records)
+{
+    return dir.filePath(QString("proverbs-%1.json").arg(records));
+}
+
+void FakraBenchmark::load_data()
+{
+    QTest::addColumn<int>("records");
+    QTest::addColumn<bool>("lazy");
+
+    // Eager copies every field into the columns, lazy leaves the details
+    // in the mapped snapshot
+    for (int records : scales()) {
+        QTest::newRow(qPrintable(QString("%1/eager").arg(records))) << records << false;
+        QTest::newRow(qPrintable(QString("%1/lazy").arg(records))) << records << true;
+    }
+}
+
+void FakraBenchmark::load()
+{
+    QFETCH(int, records);
+    QFETCH(bool, lazy);
+
+    QString path = snapshotPath(records);
+    {
+        ProverbJournal journal(path);
+        QVERIFY(journal.writeSnapshot(ProverbColumns::fromList(corpus(records))));
+    }
+
+    // The first load parses the JSON and writes the binary cache the
+    // measured loads then map, as on every start after the first
+    {
+        ProverbJournal journal(path);
+        QList<Proverb> proverbs;
+        QVERIFY(journal.load(proverbs));
+    }
+
+    QBENCHMARK {
+        ProverbJournal journal(path);
+        QList<Proverb> proverbs;
+        journal.load(proverbs);
+
+        ProverbStore loaded;
+        loaded.reset(proverbs, lazy ? MappedSnapshots{journal.mappedSnapshot()} : MappedSnapshots());
+    }
+}
+
+void FakraBenchmark::loadSharded_data()
+{
+    QTest::addColumn<int>("records");
+    QTest::addColumn<int>("shards");
+
+    // One shard loads like the single file; more spread over the cores
+    for (int records : scales()) {
+        for (int shards : {1, 4, 16}) {
+            QTest::newRow(qPrintable(QString("%1/%2").arg(records).arg(shards))) << records << shards;
+        }
+    }
+}
+
+void FakraBenchmark::loadSharded()
+{
+    QFETCH(int, records);
+    QFETCH(int, shards);
+
+    QString path = dir.filePath(QString("collection-%1-%2").arg(records).arg(shards));
+    {
+        ProverbCollection collection(path, ProverbCollection::ByHash, shards);
+        QList<Proverb> proverbs;
+        QVERIFY(!collection.load(proverbs));
+        collection.markDirty(store(records).columns());
+        QVERIFY(collection.writeSnapshot(store(records).columns()));
+    }
+
+    // As for load(), the first load leaves binary caches behind
+    {
+        ProverbCollection collection(path);
+        QList<Proverb> proverbs;
+        QVERIFY(collection.load(proverbs));
+        QCOMPARE(int(proverbs.size()), records);
+    }
+
+    QBENCHMARK {
+        ProverbCollection collection(path);
+        QList<Proverb> proverbs;
+        collection.load(proverbs);
+
+        ProverbStore loaded;
+        loaded.reset(proverbs, collection.mappedSnapshots());
+    }
+}
+
+void FakraBenchmark::save_data()
+{
+    addScales();
+}
+
+void FakraBenchmark::save()
+{
+    QFETCH(int, records);
+
+    const ProverbStore &source = store(records);
+    ProverbJournal journal(snapshotPath(records));
+
+    QBENCHMARK {
+        journal.writeSnapshot(source.columns());
+    }
+}
+
+void FakraBenchmark::search_data()
+{
+    addQueries();
+}
+
+void FakraBenchmark::search()
+{
+    QFETCH(int, records);
+    QFETCH(QString, query);
+
+    const ProverbStore &source = store(records);
+    QString normalized = ProverbIndex::normalize(query);
+
+    QBENCHMARK {
+        ProverbFilter::search(source.index(), normalized, ProverbFilter::CancelCheck());
+    }
+}
+
+void FakraBenchmark::searchLegacyScan_data()
+{
+    addQueries();
+}
+
+void FakraBenchmark::searchLegacyScan()
+{
+    QFETCH(int, records);
+    QFETCH(QString, query);
+
+    // The original per-keystroke loop, kept as the baseline for search()
+    const QList<Proverb> &proverbs = corpus(records);
+    QString lowered = query.toLower();
+
+    QBENCHMARK {
+        QVector<int> rows;
+        for (int row = 0; row < proverbs.size(); ++row) {
+            const Proverb &p = proverbs[row];
+            bool match = p.proverb.toLower().contains(lowered) ||
+                         p.transliteration.toLower().contains(lowered) ||
+                         p.meaning.toLower().contains(lowered);
+            for (int i = 0; !match && i < p.tags.size(); ++i) {
+                match = p.tags[i].toLower().contains(lowered);
+            }
+            if (match) {
+                rows.append(row);
+            }
+        }
+    }
+}
+
+void FakraBenchmark::databaseQuery_data()
+{
+    addQueries();
+}
+
+void FakraBenchmark::databaseQuery()
+{
+    QFETCH(int, records);
+    QFETCH(QString, query);
+
+    // Written once per scale; every query row then reads the same file
+    QString path = dir.filePath(QString("proverbs-%1.sqlite").arg(records));
+    bool written = QFile::exists(path);
+    ProverbDatabase database(path);
+    QVERIFY2(database.isOpen(), qPrintable(database.errorString()));
+    if (!written) {
+        database.markDirty(store(records).columns());
+        QVERIFY2(database.writeSnapshot(store(records).columns()), qPrintable(database.errorString()));
+    }
+
+    // One page with its total, as the CLI asks for it
+    ProverbFilter filter;
+    filter.searchText = ProverbIndex::normalize(query);
+    QBENCHMARK {
+        database.query(filter, 0, 10);
+    }
+}
+
+void FakraBenchmark::typeAhead_data()
+{
+    QTest::addColumn<int>("records");
+    QTest::addColumn<bool>("cached");
+
+    for (int records : scales()) {
+        QTest::newRow(qPrintable(QString("%1/uncached").arg(records))) << records << false;
+        QTest::newRow(qPrintable(QString("%1/cached").arg(records))) << records << true;
+    }
+}
+
+void FakraBenchmark::typeAhead()
+{
+    QFETCH(int, records);
+    QFETCH(bool, cached);
+
+    // Every keystroke of a query typed out, then two backspaces
+    const ProverbStore &source = store(records);
+    const QString typed = "river village";
+    QStringList keystrokes;
+    for (int length = 1; length <= typed.size(); ++length) {
+        keystrokes.append(typed.left(length));
+    }
+    keystrokes.append(typed.left(typed.size() - 1));
+    keystrokes.append(typed.left(typed.size() - 2));
+
+    QBENCHMARK {
+        QueryCache cache;
+        for (const QString &text : keystrokes) {
+            ProverbFilter filter;
+            filter.searchText = ProverbIndex::normalize(text);
+            if (cached) {
+                cache.query(source, filter);
+            } else {
+                source.query(filter);
+            }
+        }
+    }
+}
+
+void FakraBenchmark::applyFilters_data()
+{
+    QTest::addColumn<int>("records");
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<bool>("ranked");
+    QTest::addColumn<bool>("faceted");
+    for (int records : scales()) {
+        QString scale = QString::number(records);
+        QTest::newRow(qPrintable(scale + "/all")) << records << QString() << false << false;
+        QTest::newRow(qPrintable(scale + "/facets")) << records << QString() << false << true;
+        QTest::newRow(qPrintable(scale + "/search+facets")) << records << QString("water") << false << true;
+        QTest::newRow(qPrintable(scale + "/ranked")) << records << QString("river village") << true << false;
+    }
+}
+
+void FakraBenchmark::applyFilters()
+{
+    QFETCH(int, records);
+    QFETCH(QString, query);
+    QFETCH(bool, ranked);
+    QFETCH(bool, faceted);
+
+    const ProverbStore &source = store(records);
+
+    ProverbFilter filter;
+    filter.searchText = ProverbIndex::normalize(query);
+    filter.ranked = ranked;
+    if (faceted) {
+        // The most common tag and region, so the facets do real work
+        filter.tag = CorpusGenerator::tagVocabulary().first();
+        filter.region = CorpusGenerator::regionVocabulary().first();
+    }
+
+    QBENCHMARK {
+        source.query(filter);
+    }
+}
+
+void FakraBenchmark::facetTerms_data()
+{
+    addScales();
+}
+
+void FakraBenchmark::facetTerms()
+{
+    QFETCH(int, records);
+
+    // What getAllTags()/getAllRegions() feed the filter combos from
+    const ProverbStore &source = store(records);
+
+    QBENCHMARK {
+        QStringList tags = source.columns().tagTerms().sortedTerms();
+        QStringList regions = source.facets().regions().sortedTerms();
+        Q_UNUSED(tags);
+        Q_UNUSED(regions);
+    }
+}
+
+void FakraBenchmark::duplicateCheck_data()
+{
+    addScales();
+}
+
+void FakraBenchmark::duplicateCheck()
+{
+    QFETCH(int, records);
+
+    ProverbStore tracked = store(records);
+    tracked.trackDuplicates();
+
+    // A lightly reworded existing record, as typed into the add dialog
+    Proverb variant = corpus(records).at(records / 2);
+    variant.proverb = variant.proverb.toUpper() + "!";
+
+    QBENCHMARK {
+        tracked.duplicates().candidates(
+            DuplicateIndex::signature(variant.proverb, variant.transliteration));
+    }
+}
+
+void FakraBenchmark::complete_data()
+{
+    addScales();
+}
+
+void FakraBenchmark::complete()
+{
+    QFETCH(int, records);
+
+    const ProverbStore &source = store(records);
+    const Proverb &sample = corpus(records).at(records / 2);
+
+    // The search box growing one letter at a time, as the completer sees it
+    QStringList prefixes;
+    for (int length = 1; length <= std::min<int>(8, int(sample.proverb.size())); ++length) {
+        prefixes.append(sample.proverb.left(length));
+    }
+
+    QBENCHMARK {
+        for (const QString &prefix : prefixes) {
+            source.completions().complete(prefix);
+        }
+    }
+}
+
+void FakraBenchmark::editWhileSnapshotted_data()
+{
+    addScales();
+}
+
+void FakraBenchmark::editWhileSnapshotted()
+{
+    QFETCH(int, records);
+
+    ProverbStore edited = store(records);
+    const Proverb sample = corpus(records).at(records / 2);
+    Proverb proverb = sample;
+    int row = 0;
+
+    // Every edit lands while a reader still holds the previous version
+    QBENCHMARK {
+        ProverbStore snapshot = edited;
+        proverb.proverb = sample.proverb + QString::number(row);
+        edited.edit(row, proverb);
+        row = (row + 7919) % records;
+        Q_UNUSED(snapshot);
+    }
+}
+
+QTEST_GUILESS_MAIN(FakraBenchmark)
+
+#include "fakrabenchmark.moc"
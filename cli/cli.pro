@@ -0,0 +1,11 @@
+QT = core concurrent network sql
+
+TARGET = fakra-cli
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../core/fakra_core.pri)
+
+SOURCES += main.cpp queryserver.cpp
+HEADERS += queryserver.h
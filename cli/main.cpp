@@ -0,0 +1,285 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <cstdio>
+
+#include "proverbcollection.h"
+#include "proverbdatabase.h"
+#include "proverbjournal.h"
+#include "proverbstore.h"
+#include "queryserver.h"
+
+namespace {
+// Queries are read, run and printed in batches of this many lines, so
+// memory stays flat however long the input is
+const int BatchSize = 4096;
+
+struct QueryResult {
+    QByteArray line;
+    qint64 micros;
+};
+
+QueryResult resultLine(const QString &query, int count, qint64 micros, const QJsonArray &rows)
+{
+    QJsonObject object;
+    object["query"] = query;
+    object["count"] = count;
+    object["micros"] = micros;
+    object["results"] = rows;
+
+    QByteArray line = QJsonDocument(object).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    return {line, micros};
+}
+
+QueryResult runQuery(const ProverbStore &store, ProverbFilter filter, const QString &query,
+                     int offset, int limit)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    filter.searchText = ProverbIndex::normalize(query);
+    FilterResult result = store.query(filter);
+    qint64 micros = timer.nsecsElapsed() / 1000;
+
+    QJsonArray rows;
+    int count = int(result.rows.size());
+    int end = limit > 0 ? qMin(count, offset + limit) : count;
+    for (int i = offset; i < end; ++i) {
+        rows.append(store.at(result.rows[i]).toProverb().toJson());
+    }
+    return resultLine(query, count, micros, rows);
+}
+
+// Only the page asked for is read from the database
+QueryResult runQuery(ProverbDatabase &database, ProverbFilter filter, const QString &query,
+                     int offset, int limit)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    filter.searchText = ProverbIndex::normalize(query);
+    ProverbDatabase::Page page = database.query(filter, offset, limit > 0 ? limit : -1);
+    qint64 micros = timer.nsecsElapsed() / 1000;
+
+    QJsonArray rows;
+    for (const Proverb &proverb : std::as_const(page.proverbs)) {
+        rows.append(proverb.toJson());
+    }
+    return resultLine(query, page.total, micros, rows);
+}
+
+// The same JSON array of records a database exports
+bool exportJson(const ProverbStore &store, const QString &path)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write("[\n");
+    for (int row = 0; row < store.size(); ++row) {
+        file.write(row == 0 ? "    " : ",\n    ");
+        file.write(QJsonDocument(store.at(row).toProverb().toJson()).toJson(QJsonDocument::Compact));
+    }
+    file.write("\n]\n");
+    return file.commit();
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("fakra-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs one proverb query per input line and prints one JSON result per line,\n"
+                                     "or with --serve answers the same queries over HTTP on 127.0.0.1.\n"
+                                     "--import-json and --export-json convert between a database and JSON.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("queries", "File with one query per line; standard input if omitted.", "[queries]");
+
+    QCommandLineOption dataOption({"d", "data"}, "Collection directory, single-file collection, or .sqlite/.db\n"
+                                  "database to search.", "path", "proverbs");
+    QCommandLineOption rankedOption({"r", "ranked"}, "Rank results with BM25 instead of substring matching.");
+    QCommandLineOption tagOption({"t", "tag"}, "Only return proverbs with this tag.", "tag");
+    QCommandLineOption regionOption("region", "Only return proverbs from this region.", "region");
+    QCommandLineOption limitOption({"l", "limit"}, "Records printed per query, 0 for all.", "n", "10");
+    QCommandLineOption offsetOption("offset", "Matches skipped before the first one printed.", "n", "0");
+    QCommandLineOption threadsOption({"j", "threads"}, "Worker threads.", "n",
+                                     QString::number(QThread::idealThreadCount()));
+    QCommandLineOption serveOption("serve", "Serve GET /search and /metrics on localhost instead of reading queries.");
+    QCommandLineOption portOption({"p", "port"}, "Port to serve on, 0 for any free one.", "port", "8765");
+    QCommandLineOption importOption("import-json", "Replace the database's records with those in a JSON array.", "file");
+    QCommandLineOption exportOption("export-json", "Write the collection as a JSON array of records.", "file");
+    parser.addOption(dataOption);
+    parser.addOption(rankedOption);
+    parser.addOption(tagOption);
+    parser.addOption(regionOption);
+    parser.addOption(limitOption);
+    parser.addOption(offsetOption);
+    parser.addOption(threadsOption);
+    parser.addOption(serveOption);
+    parser.addOption(portOption);
+    parser.addOption(importOption);
+    parser.addOption(exportOption);
+    parser.process(app);
+
+    QString dataPath = parser.value(dataOption);
+    QScopedPointer<ProverbDatabase> database;
+    if (ProverbDatabase::isDatabasePath(dataPath)) {
+        database.reset(new ProverbDatabase(dataPath));
+        if (!database->isOpen()) {
+            std::fprintf(stderr, "fakra-cli: cannot open %s: %s\n", qPrintable(dataPath),
+                         qPrintable(database->errorString()));
+            return 1;
+        }
+        if (parser.isSet(importOption) && !database->importJson(parser.value(importOption))) {
+            std::fprintf(stderr, "fakra-cli: cannot import %s: %s\n", qPrintable(parser.value(importOption)),
+                         qPrintable(database->errorString()));
+            return 1;
+        }
+        if (parser.isSet(exportOption) && !database->exportJson(parser.value(exportOption))) {
+            std::fprintf(stderr, "fakra-cli: cannot export %s: %s\n", qPrintable(parser.value(exportOption)),
+                         qPrintable(database->errorString()));
+            return 1;
+        }
+        if (parser.isSet(importOption) || parser.isSet(exportOption)) {
+            return 0;
+        }
+    } else if (parser.isSet(importOption)) {
+        std::fprintf(stderr, "fakra-cli: --import-json needs a .sqlite or .db database\n");
+        return 1;
+    }
+
+    // A database answers queries itself, a page at a time, so nothing is
+    // loaded for them; the server and the other layouts search in memory
+    bool inMemory = !database || parser.isSet(serveOption);
+    ProverbStore store;
+    if (inMemory) {
+        // The store keeps the mapped snapshots the loaded strings point into.
+        // Files are only read, so the GUI can have the same collection open.
+        QList<Proverb> proverbs;
+        MappedSnapshots details;
+        bool found;
+        if (database) {
+            found = database->load(proverbs);
+        } else if (QFileInfo(dataPath).isDir()) {
+            ProverbCollection collection(dataPath);
+            found = collection.load(proverbs, ProverbJournal::ReadOnly);
+            details = collection.mappedSnapshots();
+        } else {
+            ProverbJournal journal(dataPath);
+            found = journal.load(proverbs, ProverbJournal::ReadOnly);
+            details = {journal.mappedSnapshot()};
+        }
+        if (!found) {
+            std::fprintf(stderr, "fakra-cli: no collection at %s\n", qPrintable(dataPath));
+            return 1;
+        }
+        store.reset(proverbs, details);
+    }
+
+    if (parser.isSet(exportOption)) {
+        if (!exportJson(store, parser.value(exportOption))) {
+            std::fprintf(stderr, "fakra-cli: cannot write %s\n", qPrintable(parser.value(exportOption)));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (parser.isSet(serveOption)) {
+        // Only loopback: this is for tools on the same machine
+        QueryServer server(store, parser.value(threadsOption).toInt());
+        if (!server.listen(QHostAddress::LocalHost, quint16(parser.value(portOption).toUInt()))) {
+            std::fprintf(stderr, "fakra-cli: cannot listen on port %s: %s\n",
+                         qPrintable(parser.value(portOption)), qPrintable(server.errorString()));
+            return 1;
+        }
+        std::fprintf(stderr, "fakra-cli: serving %d proverbs on http://127.0.0.1:%d/\n",
+                     store.size(), int(server.serverPort()));
+        return app.exec();
+    }
+
+    QFile input;
+    const QStringList arguments = parser.positionalArguments();
+    bool opened;
+    if (arguments.isEmpty()) {
+        opened = input.open(stdin, QIODevice::ReadOnly | QIODevice::Text);
+    } else {
+        input.setFileName(arguments.first());
+        opened = input.open(QIODevice::ReadOnly | QIODevice::Text);
+    }
+    if (!opened) {
+        std::fprintf(stderr, "fakra-cli: cannot read %s\n", qPrintable(arguments.value(0, "standard input")));
+        return 1;
+    }
+
+    ProverbFilter filter;
+    filter.ranked = parser.isSet(rankedOption);
+    filter.tag = parser.value(tagOption);
+    filter.region = parser.value(regionOption);
+    int offset = qMax(0, parser.value(offsetOption).toInt());
+    int limit = parser.value(limitOption).toInt();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, parser.value(threadsOption).toInt()));
+
+    QFile output;
+    output.open(stdout, QIODevice::WriteOnly);
+
+    QElapsedTimer wall;
+    wall.start();
+    qint64 queries = 0;
+    qint64 queryMicros = 0;
+
+    while (!input.atEnd()) {
+        QStringList batch;
+        while (batch.size() < BatchSize && !input.atEnd()) {
+            QString query = QString::fromUtf8(input.readLine()).trimmed();
+            if (!query.isEmpty()) {
+                batch.append(query);
+            }
+        }
+
+        // blockingMapped keeps input order, so output lines match input lines.
+        // The database's connection belongs to this thread, so its queries
+        // run here one after another.
+        QList<QueryResult> results;
+        if (inMemory) {
+            results = QtConcurrent::blockingMapped(&pool, batch,
+                [&store, &filter, offset, limit](const QString &query) {
+                    return runQuery(store, filter, query, offset, limit);
+                });
+        } else {
+            for (const QString &query : std::as_const(batch)) {
+                results.append(runQuery(*database, filter, query, offset, limit));
+            }
+        }
+
+        for (const QueryResult &result : results) {
+            output.write(result.line);
+            queryMicros += result.micros;
+        }
+        output.flush();
+        queries += results.size();
+    }
+
+    qint64 elapsed = qMax<qint64>(1, wall.elapsed());
+    std::fprintf(stderr, "%lld queries in %lld ms on %d threads: %.1f queries/s, %.1f us/query\n",
+                 qlonglong(queries), qlonglong(elapsed), inMemory ? pool.maxThreadCount() : 1,
+                 queries * 1000.0 / elapsed,
+                 queries > 0 ? double(queryMicros) / queries : 0.0);
+    return 0;
+}
@@ -0,0 +1,260 @@
+#include "queryserver.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpSocket>
+#include <QUrl>
+
+#include "metrics.h"
+
+namespace {
+// Blocking waits are cut into slices so shutdown is noticed promptly
+const int PollInterval = 200;   // ms
+
+QByteArray reasonPhrase(int status)
+{
+    switch (status) {
+    case 200:
+        return "OK";
+    case 400:
+        return "Bad Request";
+    case 404:
+        return "Not Found";
+    case 405:
+        return "Method Not Allowed";
+    default:
+        return "Error";
+    }
+}
+
+QJsonObject facetCounts(const TermDictionary &terms, const QVector<int> &counts)
+{
+    QJsonObject object;
+    for (int id = 0; id < counts.size(); ++id) {
+        if (counts[id] > 0) {
+            object[terms.term(id)] = counts[id];
+        }
+    }
+    return object;
+}
+}
+
+QueryServer::QueryServer(const ProverbStore &store, int threads, QObject *parent)
+    : QTcpServer(parent),
+    snapshot(store)
+{
+    pool.setMaxThreadCount(qMax(1, threads));
+}
+
+QueryServer::~QueryServer()
+{
+    close();
+    stopping.storeRelaxed(1);
+    pool.waitForDone();
+}
+
+void QueryServer::incomingConnection(qintptr descriptor)
+{
+    // The socket is created on the worker, which then owns it entirely
+    pool.start([this, descriptor]() {
+        serve(descriptor);
+    });
+}
+
+void QueryServer::serve(qintptr descriptor)
+{
+    QTcpSocket socket;
+    if (!socket.setSocketDescriptor(descriptor)) {
+        return;
+    }
+
+    // Pipelined requests stay in buffer until their turn
+    QByteArray buffer;
+    Request request;
+    while (readRequest(socket, buffer, &request)) {
+        QByteArray reply;
+        {
+            FAKRA_TIMED_SCOPE("serverRequest");
+            reply = format(respond(request), request.keepAlive);
+        }
+
+        socket.write(reply);
+        while (socket.bytesToWrite() > 0 && socket.waitForBytesWritten(IdleTimeout)) {
+        }
+        if (!request.keepAlive || socket.state() != QAbstractSocket::ConnectedState) {
+            break;
+        }
+    }
+
+    socket.disconnectFromHost();
+    if (socket.state() != QAbstractSocket::UnconnectedState) {
+        socket.waitForDisconnected(PollInterval);
+    }
+}
+
+bool QueryServer::waitForData(QTcpSocket &socket) const
+{
+    QElapsedTimer idle;
+    idle.start();
+    while (!stopping.loadRelaxed() && idle.elapsed() < IdleTimeout) {
+        if (socket.waitForReadyRead(PollInterval)) {
+            return true;
+        }
+        if (socket.state() != QAbstractSocket::ConnectedState) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool QueryServer::readRequest(QTcpSocket &socket, QByteArray &buffer, Request *request) const
+{
+    qsizetype end;
+    while ((end = buffer.indexOf("\r\n\r\n")) < 0) {
+        if (buffer.size() > MaxHeaderBytes || !waitForData(socket)) {
+            return false;
+        }
+        buffer.append(socket.readAll());
+    }
+
+    const QList<QByteArray> lines = buffer.left(end).split('\n');
+    buffer.remove(0, end + 4);
+
+    *request = Request();
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() != 3 || !requestLine[2].startsWith("HTTP/1.")) {
+        return true;
+    }
+
+    // HTTP/1.1 keeps connections open unless told otherwise, 1.0 the reverse
+    bool keepAlive = requestLine[2] == "HTTP/1.1";
+    qint64 bodyLength = 0;
+    for (int i = 1; i < lines.size(); ++i) {
+        int colon = int(lines[i].indexOf(':'));
+        if (colon < 0) {
+            continue;
+        }
+        QByteArray name = lines[i].left(colon).trimmed().toLower();
+        QByteArray value = lines[i].mid(colon + 1).trimmed().toLower();
+        if (name == "connection") {
+            if (value.contains("close")) {
+                keepAlive = false;
+            } else if (value.contains("keep-alive")) {
+                keepAlive = true;
+            }
+        } else if (name == "content-length") {
+            bodyLength = value.toLongLong();
+        }
+    }
+
+    // Queries carry no body; one sent anyway is skipped over
+    if (bodyLength < 0 || bodyLength > MaxHeaderBytes) {
+        return true;
+    }
+    while (buffer.size() < bodyLength) {
+        if (!waitForData(socket)) {
+            return false;
+        }
+        buffer.append(socket.readAll());
+    }
+    buffer.remove(0, bodyLength);
+
+    request->method = requestLine[0];
+    request->target = requestLine[1];
+    request->keepAlive = keepAlive;
+    return true;
+}
+
+QueryServer::Response QueryServer::respond(const Request &request)
+{
+    if (request.method.isEmpty()) {
+        return error(400, "malformed request");
+    }
+    if (request.method != "GET") {
+        return error(405, "only GET is supported");
+    }
+
+    QUrl url = QUrl::fromEncoded(request.target);
+    if (!url.isValid()) {
+        return error(400, "malformed request target");
+    }
+
+    if (url.path() == "/search") {
+        // Form encoding writes spaces as '+'; a literal plus arrives as %2B
+        return search(QUrlQuery(url.query(QUrl::FullyEncoded).replace('+', "%20")));
+    }
+    if (url.path() == "/metrics") {
+        return {200, QJsonDocument(Metrics::instance().toJson()).toJson(QJsonDocument::Compact)};
+    }
+    return error(404, "unknown path " + url.path());
+}
+
+QueryServer::Response QueryServer::search(const QUrlQuery &query)
+{
+    auto value = [&query](const QString &key) {
+        return query.queryItemValue(key, QUrl::FullyDecoded);
+    };
+
+    ProverbFilter filter;
+    filter.searchText = ProverbIndex::normalize(value("q"));
+    filter.tag = value("tag");
+    filter.region = value("region");
+    filter.ranked = value("ranked") == "1" || value("ranked") == "true";
+
+    bool ok = true;
+    int offset = query.hasQueryItem("offset") ? value("offset").toInt(&ok) : 0;
+    if (!ok || offset < 0) {
+        return error(400, "offset must be a non-negative integer");
+    }
+    int limit = query.hasQueryItem("limit") ? value("limit").toInt(&ok) : DefaultLimit;
+    if (!ok || limit < 0) {
+        return error(400, "limit must be a non-negative integer");
+    }
+    limit = qMin(limit, int(MaxLimit));
+
+    FilterResult result;
+    {
+        FAKRA_TIMED_SCOPE("serverQuery");
+        result = cache.query(snapshot, filter);
+    }
+
+    QJsonArray rows;
+    int end = int(qMin<qint64>(result.rows.size(), qint64(offset) + limit));
+    for (int i = offset; i < end; ++i) {
+        rows.append(snapshot.at(result.rows[i]).toProverb().toJson());
+    }
+
+    QJsonObject object;
+    object["query"] = value("q");
+    object["tag"] = filter.tag;
+    object["region"] = filter.region;
+    object["ranked"] = filter.ranked;
+    object["count"] = int(result.rows.size());
+    object["offset"] = offset;
+    object["limit"] = limit;
+    object["results"] = rows;
+    object["tags"] = facetCounts(snapshot.columns().tagTerms(), result.tagCounts);
+    object["regions"] = facetCounts(snapshot.facets().regions(), result.regionCounts);
+    return {200, QJsonDocument(object).toJson(QJsonDocument::Compact)};
+}
+
+QueryServer::Response QueryServer::error(int status, const QString &message)
+{
+    QJsonObject object;
+    object["error"] = message;
+    return {status, QJsonDocument(object).toJson(QJsonDocument::Compact)};
+}
+
+QByteArray QueryServer::format(const Response &response, bool keepAlive)
+{
+    QByteArray reply = "HTTP/1.1 " + QByteArray::number(response.status) + ' ' +
+                       reasonPhrase(response.status) + "\r\n";
+    reply += "Content-Type: application/json; charset=utf-8\r\n";
+    reply += "Content-Length: " + QByteArray::number(response.body.size()) + "\r\n";
+    reply += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    reply += "\r\n";
+    reply += response.body;
+    return reply;
+}
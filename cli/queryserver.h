@@ -0,0 +1,68 @@
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QTcpServer>
+#include <QThreadPool>
+#include <QUrlQuery>
+
+#include "proverbstore.h"
+#include "querycache.h"
+
+class QTcpSocket;
+
+// Answers proverb queries as JSON over HTTP/1.1, for tools that would
+// otherwise parse the collection themselves:
+//   GET /search?q=...&tag=...&region=...&ranked=1&offset=0&limit=20
+//   GET /metrics
+// Search parameters mean what the main window's search box, filters and
+// ranking checkbox do. Each connection is served with blocking reads on a
+// pool thread and kept alive until the client closes it or stays idle for
+// IdleTimeout, so a pool of N threads serves N connections at once and the
+// rest wait their turn. All workers read one store snapshot that is never
+// modified, sharing a QueryCache.
+class QueryServer : public QTcpServer {
+    Q_OBJECT
+
+public:
+    static const int IdleTimeout = 5000;       // ms
+    static const int MaxHeaderBytes = 16 * 1024;
+    static const int DefaultLimit = 20;
+    static const int MaxLimit = 1000;
+
+    QueryServer(const ProverbStore &store, int threads, QObject *parent = nullptr);
+    // Stops accepting and waits for open connections to wind down
+    ~QueryServer() override;
+
+protected:
+    void incomingConnection(qintptr descriptor) override;
+
+private:
+    struct Request {
+        QByteArray method;      // empty for a request that could not be parsed
+        QByteArray target;
+        bool keepAlive = false;
+    };
+
+    struct Response {
+        int status;
+        QByteArray body;
+    };
+
+    void serve(qintptr descriptor);
+    bool waitForData(QTcpSocket &socket) const;
+    // False once the connection is closed, idle or unusable
+    bool readRequest(QTcpSocket &socket, QByteArray &buffer, Request *request) const;
+    Response respond(const Request &request);
+    Response search(const QUrlQuery &query);
+    static Response error(int status, const QString &message);
+    static QByteArray format(const Response &response, bool keepAlive);
+
+    const ProverbStore snapshot;
+    QueryCache cache;
+    QThreadPool pool;
+    QAtomicInt stopping;
+};
+
+#endif // QUERYSERVER_H
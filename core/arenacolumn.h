@@ -0,0 +1,158 @@
+#ifndef ARENACOLUMN_H
+#define ARENACOLUMN_H
+
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <algorithm>
+
+#include "chunkedvector.h"
+
+// One variable-length value per row, packed into large blocks and
+// addressed by (block, offset, length). Scanning a column walks a few big
+// blocks of memory instead of chasing a heap pointer per row. Replaced
+// and removed values leave holes that are squeezed out once they outweigh
+// the live data.
+//
+// Values are never written over, only appended, so copies share every
+// block: a copy pins what it can see, and an edit through another copy
+// appends past it instead of cloning the arena. Whichever copy first
+// claims the free tail of a block keeps appending there; the others start
+// a block of their own.
+template <typename T>
+class ArenaColumn {
+public:
+    // Values are packed into blocks this size; a longer one gets its own
+    static const int BlockSize = 1 << 16;
+
+    int size() const { return places.size(); }
+
+    const T *data(int row) const
+    {
+        const Slot &slot = places.at(row);
+        if (slot.length == 0) {
+            return nullptr;
+        }
+        return blocks.at(slot.location >> OffsetBits)->values + (slot.location & OffsetMask);
+    }
+
+    int length(int row) const { return int(places.at(row).length); }
+
+    // values must not point into this column's own arena
+    void append(const T *values, int count)
+    {
+        places.append(place(values, count));
+    }
+
+    void set(int row, const T *values, int count)
+    {
+        garbage += places.at(row).length;
+        places[row] = place(values, count);
+        squeezeIfWasteful();
+    }
+
+    // Keeps only the rows a RowSlots::compact() table gives a new number,
+    // packed into fresh blocks in order
+    void keepLive(const QVector<int> &renumbered)
+    {
+        ArenaColumn packed;
+        packed.reserve(size());
+        for (int row = 0; row < renumbered.size(); ++row) {
+            if (renumbered[row] >= 0) {
+                packed.append(data(row), length(row));
+            }
+        }
+        *this = packed;
+    }
+
+    void clear()
+    {
+        blocks.clear();
+        places.clear();
+        tailUsed = 0;
+        stored = 0;
+        garbage = 0;
+    }
+
+    void reserve(int rows)
+    {
+        places.reserve(rows);
+    }
+
+    // Arena elements no longer referenced by any row
+    qint64 wasted() const { return garbage; }
+
+private:
+    static const int OffsetBits = 16;
+    static const quint32 OffsetMask = (1u << OffsetBits) - 1;
+
+    struct Block {
+        explicit Block(int capacity)
+            : values(new T[capacity]),
+            capacity(capacity)
+        {
+        }
+        ~Block() { delete[] values; }
+        Q_DISABLE_COPY(Block)
+
+        T *values;
+        const int capacity;
+        QAtomicInt claimed;     // elements handed out, to whichever copy
+    };
+
+    struct Slot {
+        quint32 location = 0;   // block index, then offset in the block
+        quint32 length = 0;
+    };
+
+    Slot place(const T *values, int count)
+    {
+        Slot slot;
+        slot.length = quint32(count);
+        if (count == 0) {
+            return slot;
+        }
+
+        // Claiming the tail fails once another copy has appended past
+        // the end this one knows about
+        bool fits = !blocks.isEmpty() && tailUsed + count <= blocks.last()->capacity &&
+                    blocks.last()->claimed.testAndSetOrdered(tailUsed, tailUsed + count);
+        if (!fits) {
+            QSharedPointer<Block> block(new Block(std::max(count, int(BlockSize))));
+            block->claimed.storeRelaxed(count);
+            blocks.append(block);
+            tailUsed = 0;
+        }
+
+        slot.location = (quint32(blocks.size() - 1) << OffsetBits) | quint32(tailUsed);
+        std::copy(values, values + count, blocks.last()->values + tailUsed);
+        tailUsed += count;
+        stored += count;
+        return slot;
+    }
+
+    void squeezeIfWasteful()
+    {
+        if (garbage < 4096 || garbage * 2 < stored) {
+            return;
+        }
+
+        // Rewrite the live values in row order into fresh blocks; copies
+        // still holding the old ones keep them alive
+        ArenaColumn packed;
+        packed.reserve(size());
+        for (int row = 0; row < size(); ++row) {
+            packed.append(data(row), length(row));
+        }
+        *this = packed;
+    }
+
+    QVector<QSharedPointer<Block>> blocks;
+    ChunkedVector<Slot> places;
+    int tailUsed = 0;           // elements of the last block this copy owns
+    qint64 stored = 0;
+    qint64 garbage = 0;
+};
+
+#endif // ARENACOLUMN_H
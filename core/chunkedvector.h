@@ -0,0 +1,60 @@
+#ifndef CHUNKEDVECTOR_H
+#define CHUNKEDVECTOR_H
+
+#include <QSharedData>
+#include <QSharedDataPointer>
+#include <QVector>
+
+// Vector stored as fixed-size chunks that copies share and detach one at a
+// time. Copying is O(1) like any implicitly shared container, but writing
+// to a copy only clones the array of chunk pointers and the chunk written
+// to, so holding a snapshot makes an edit cost O(ChunkSize + size /
+// ChunkSize) rather than a copy of everything. There is no removeAt():
+// owners empty a RowSlots slot in place instead of shifting every chunk.
+//
+// Reading through a non-const vector detaches like QVector does; use at()
+// there.
+template <typename T>
+class ChunkedVector {
+public:
+    static const int ChunkBits = 10;
+    static const int ChunkSize = 1 << ChunkBits;
+
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+
+    const T &at(int i) const { return chunks.at(i >> ChunkBits)->values[i & Mask]; }
+    const T &operator[](int i) const { return at(i); }
+    T &operator[](int i) { return chunks[i >> ChunkBits]->values[i & Mask]; }
+    const T &last() const { return at(count - 1); }
+    T &last() { return (*this)[count - 1]; }
+
+    void append(const T &value)
+    {
+        if ((count & Mask) == 0) {
+            chunks.append(QSharedDataPointer<Chunk>(new Chunk));
+        }
+        chunks.last()->values[count & Mask] = value;
+        ++count;
+    }
+
+    void reserve(int size) { chunks.reserve((size + Mask) >> ChunkBits); }
+
+    void clear()
+    {
+        chunks.clear();
+        count = 0;
+    }
+
+private:
+    static const int Mask = ChunkSize - 1;
+
+    struct Chunk : public QSharedData {
+        T values[ChunkSize];
+    };
+
+    QVector<QSharedDataPointer<Chunk>> chunks;
+    int count = 0;
+};
+
+#endif // CHUNKEDVECTOR_H
@@ -0,0 +1,357 @@
+#include "completionindex.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "proverbindex.h"
+#include "proverbranker.h"
+
+namespace {
+QString clipped(const QString &text)
+{
+    if (text.size() <= CompletionIndex::MaxTermLength) {
+        return text;
+    }
+    // Never leave half a surrogate pair behind
+    int length = CompletionIndex::MaxTermLength;
+    if (text[length - 1].isHighSurrogate()) {
+        --length;
+    }
+    return text.left(length);
+}
+
+// The first few words of a normalized proverb, single-spaced
+QString openingOf(const QString &normalized)
+{
+    const QStringList words = normalized.simplified().split(' ', Qt::SkipEmptyParts);
+    return clipped(words.mid(0, CompletionIndex::OpeningWords).join(' '));
+}
+}
+
+void CompletionIndex::build(const QList<Proverb> &proverbs)
+{
+    clear();
+    slotUses.reserve(proverbs.size());
+
+    // Weights are summed first and every top list computed once at the end,
+    // instead of refreshing the popular paths once per row
+    for (const Proverb &p : proverbs) {
+        QVector<int> uses = usesFor(p);
+        addUses(uses, 1, false);
+        rowSlots.append();
+        slotUses.append(uses);
+    }
+    refreshAll();
+}
+
+void CompletionIndex::clear()
+{
+    nodes.clear();
+    terms.clear();
+    termIds.clear();
+    rowSlots.clear();
+    slotUses.clear();
+}
+
+void CompletionIndex::append(const Proverb &proverb)
+{
+    QVector<int> uses = usesFor(proverb);
+    addUses(uses, 1);
+    rowSlots.append();
+    slotUses.append(uses);
+}
+
+void CompletionIndex::update(int row, const Proverb &proverb)
+{
+    if (row < 0 || row >= rowSlots.size()) {
+        return;
+    }
+
+    int slot = rowSlots.slotOf(row);
+    QVector<int> uses = usesFor(proverb);
+    addUses(slotUses.at(slot), -1);
+    addUses(uses, 1);
+    slotUses[slot] = uses;
+}
+
+void CompletionIndex::remove(int row)
+{
+    if (row < 0 || row >= rowSlots.size()) {
+        return;
+    }
+
+    int slot = rowSlots.remove(row);
+    addUses(slotUses.at(slot), -1);
+    slotUses[slot] = QVector<int>();
+
+    if (rowSlots.wantsCompaction()) {
+        slotUses = RowSlots::keepLive(slotUses, rowSlots.compact());
+    }
+}
+
+QList<CompletionIndex::Completion> CompletionIndex::complete(const QString &prefix, int limit) const
+{
+    QList<Completion> result;
+
+    // Whitespace is collapsed as in openings, but a trailing space stays so
+    // "river " only offers openings going on past that word
+    QString key = ProverbIndex::normalize(prefix);
+    bool trailingSpace = !key.isEmpty() && key.back().isSpace();
+    key = key.simplified();
+    if (key.isEmpty() || nodes.isEmpty()) {
+        return result;
+    }
+    if (trailingSpace) {
+        key.append(' ');
+    }
+
+    int node = 0;
+    int pos = 0;
+    while (pos < key.size()) {
+        int child = childStartingWith(node, key[pos]);
+        if (child < 0) {
+            return result;
+        }
+        QStringView edge = label(nodes[child]);
+        qsizetype length = std::min<qsizetype>(edge.size(), key.size() - pos);
+        if (edge.left(length) != QStringView(key).mid(pos, length)) {
+            return result;
+        }
+        node = child;
+        pos += int(length);
+    }
+
+    const Node &found = nodes[node];
+    for (int i = 0; i < std::min(limit, int(TopK)) && found.top[i] >= 0; ++i) {
+        const Term &term = terms[found.top[i]];
+        int kind = int(std::max_element(term.counts, term.counts + KindCount) - term.counts);
+        result.append(Completion{term.text, Kind(kind), term.weight});
+    }
+    return result;
+}
+
+QVector<int> CompletionIndex::usesFor(const Proverb &proverb)
+{
+    QVector<int> uses;
+    auto use = [this, &uses](const QString &text, Kind kind) {
+        QString term = clipped(text.trimmed());
+        if (term.isEmpty()) {
+            return;
+        }
+        int code = termFor(term) * KindCount + kind;
+        if (!uses.contains(code)) {
+            uses.append(code);
+        }
+    };
+
+    use(openingOf(ProverbIndex::normalize(proverb.proverb)), Opening);
+    const QStringList words = ProverbRanker::tokenize(ProverbIndex::normalize(proverb.transliteration));
+    for (const QString &word : words) {
+        use(word, Word);
+    }
+    for (const QString &tag : proverb.tags) {
+        use(ProverbIndex::normalize(tag).simplified(), Tag);
+    }
+    use(ProverbIndex::normalize(proverb.region).simplified(), Region);
+    return uses;
+}
+
+void CompletionIndex::addUses(const QVector<int> &uses, int delta, bool refreshPaths)
+{
+    for (int code : uses) {
+        int id = code / KindCount;
+        terms[id].counts[code % KindCount] += delta;
+        terms[id].weight += delta;
+
+        if (refreshPaths) {
+            for (int node = terms.at(id).node; node >= 0 && refresh(node, id); node = nodes.at(node).parent) {
+            }
+        }
+    }
+}
+
+int CompletionIndex::termFor(const QString &text)
+{
+    const int *known = std::as_const(termIds).find(text);
+    if (known) {
+        return *known;
+    }
+
+    // Terms whose weight drops to zero are kept, so their nodes stay valid
+    // and a later row using them again finds them
+    int id = int(terms.size());
+    Term term;
+    term.text = text;
+    std::fill(term.counts, term.counts + KindCount, 0);
+    term.weight = 0;
+    term.node = -1;
+    terms.append(term);
+    termIds.insert(text, id);
+    terms[id].node = insertNode(id);
+    return id;
+}
+
+int CompletionIndex::insertNode(int termId)
+{
+    if (nodes.isEmpty()) {
+        newNode(-1, 0, 0, -1);
+    }
+
+    const QString key = terms.at(termId).text;
+    int node = 0;
+    int pos = 0;
+    while (pos < key.size()) {
+        int child = childStartingWith(node, key[pos]);
+        if (child < 0) {
+            int leaf = newNode(termId, pos, int(key.size()) - pos, node);
+            nodes[leaf].nextSibling = nodes[node].firstChild;
+            nodes[node].firstChild = leaf;
+            nodes[leaf].term = termId;
+            return leaf;
+        }
+
+        QStringView edge = label(nodes.at(child));
+        int common = 1;
+        while (common < edge.size() && pos + common < key.size() && edge[common] == key[pos + common]) {
+            ++common;
+        }
+
+        if (common < edge.size()) {
+            // Split the edge; the new middle node covers the shared part and
+            // starts out with the same subtree, hence the same top list
+            int mid = newNode(nodes.at(child).labelTerm, nodes.at(child).labelStart, common, node);
+            Node &middle = nodes[mid];
+            Node &lower = nodes[child];
+            std::copy(lower.top, lower.top + TopK, middle.top);
+            middle.firstChild = child;
+            middle.nextSibling = lower.nextSibling;
+            lower.labelStart += common;
+            lower.labelLength -= common;
+            lower.parent = mid;
+            lower.nextSibling = -1;
+
+            if (nodes.at(node).firstChild == child) {
+                nodes[node].firstChild = mid;
+            } else {
+                int previous = nodes.at(node).firstChild;
+                while (nodes.at(previous).nextSibling != child) {
+                    previous = nodes.at(previous).nextSibling;
+                }
+                nodes[previous].nextSibling = mid;
+            }
+            child = mid;
+        }
+
+        node = child;
+        pos += common;
+    }
+
+    nodes[node].term = termId;
+    return node;
+}
+
+int CompletionIndex::newNode(int labelTerm, int start, int length, int parent)
+{
+    Node node;
+    node.labelTerm = labelTerm;
+    node.labelStart = quint16(start);
+    node.labelLength = quint16(length);
+    node.parent = parent;
+    node.firstChild = -1;
+    node.nextSibling = -1;
+    node.term = -1;
+    std::fill(node.top, node.top + TopK, -1);
+    nodes.append(node);
+    return int(nodes.size()) - 1;
+}
+
+int CompletionIndex::childStartingWith(int node, QChar c) const
+{
+    for (int child = nodes[node].firstChild; child >= 0; child = nodes[child].nextSibling) {
+        if (label(nodes[child]).front() == c) {
+            return child;
+        }
+    }
+    return -1;
+}
+
+QStringView CompletionIndex::label(const Node &node) const
+{
+    if (node.labelTerm < 0) {
+        return QStringView();
+    }
+    return QStringView(terms.at(node.labelTerm).text).mid(node.labelStart, node.labelLength);
+}
+
+bool CompletionIndex::heavier(int a, int b) const
+{
+    const Term &x = terms.at(a);
+    const Term &y = terms.at(b);
+    if (x.weight != y.weight) {
+        return x.weight > y.weight;
+    }
+    // Among equals the shorter, then alphabetically first, term wins
+    if (x.text.size() != y.text.size()) {
+        return x.text.size() < y.text.size();
+    }
+    return x.text < y.text;
+}
+
+bool CompletionIndex::refresh(int node, int changedTerm)
+{
+    qint32 best[TopK];
+    std::fill(best, best + TopK, -1);
+    int count = 0;
+
+    auto offer = [this, &best, &count](int id) {
+        if (id < 0 || terms.at(id).weight <= 0) {
+            return;
+        }
+        if (count == TopK && !heavier(id, best[TopK - 1])) {
+            return;
+        }
+        int at = std::min(count, int(TopK) - 1);
+        while (at > 0 && heavier(id, best[at - 1])) {
+            best[at] = best[at - 1];
+            --at;
+        }
+        best[at] = id;
+        count = std::min(count + 1, int(TopK));
+    };
+
+    // Each child's list is the best of its subtree, so the best of this
+    // subtree is among them and the term ending here
+    offer(nodes.at(node).term);
+    for (int child = nodes.at(node).firstChild; child >= 0; child = nodes.at(child).nextSibling) {
+        const qint32 *top = nodes.at(child).top;
+        for (int i = 0; i < TopK && top[i] >= 0; ++i) {
+            offer(top[i]);
+        }
+    }
+
+    // An unchanged list without the changed term looks the same from above
+    qint32 *top = nodes[node].top;
+    bool same = std::equal(best, best + TopK, top);
+    std::copy(best, best + TopK, top);
+    return !same || std::find(best, best + TopK, changedTerm) != best + TopK;
+}
+
+void CompletionIndex::refreshAll()
+{
+    if (nodes.isEmpty()) {
+        return;
+    }
+
+    // Children before parents: the reverse of a breadth-first order
+    QVector<int> order;
+    order.reserve(nodes.size());
+    order.append(0);
+    for (int i = 0; i < order.size(); ++i) {
+        for (int child = nodes.at(order[i]).firstChild; child >= 0; child = nodes.at(child).nextSibling) {
+            order.append(child);
+        }
+    }
+    for (int i = int(order.size()) - 1; i >= 0; --i) {
+        refresh(order[i], -1);
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef COMPLETIONINDEX_H
+#define COMPLETIONINDEX_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "chunkedvector.h"
+#include "proverb.h"
+#include "rowslots.h"
+#include "shardedhash.h"
+
+// Weighted prefix completions over proverb openings, transliteration
+// words, tags and regions, all normalized like ProverbIndex keys. Terms sit
+// in a radix trie whose edge labels point into the term text rather than
+// copying it. Every node keeps the TopK heaviest terms below it, so a
+// lookup walks the typed prefix once and reads the answer off that node.
+// A term's weight is the number of rows using it; rows follow the
+// collection like ProverbIndex, kept by slot the same way, and each change
+// only refreshes the nodes on its terms' paths.
+class CompletionIndex {
+public:
+    static const int TopK = 8;
+    // Words of a proverb kept as its opening
+    static const int OpeningWords = 6;
+    static const int MaxTermLength = 64;
+
+    enum Kind {
+        Opening,
+        Word,
+        Tag,
+        Region,
+        KindCount
+    };
+
+    struct Completion {
+        QString text;
+        Kind kind;       // the use most rows make of the term
+        int weight;
+    };
+
+    void build(const QList<Proverb> &proverbs);
+    void clear();
+
+    void append(const Proverb &proverb);
+    void update(int row, const Proverb &proverb);
+    void remove(int row);
+
+    // Up to limit (at most TopK) terms starting with the normalized prefix,
+    // heaviest first
+    QList<Completion> complete(const QString &prefix, int limit = TopK) const;
+
+private:
+    struct Term {
+        QString text;
+        int counts[KindCount];
+        int weight;
+        int node;
+    };
+
+    struct Node {
+        qint32 labelTerm;      // term whose text holds the edge label
+        quint16 labelStart;
+        quint16 labelLength;
+        qint32 parent;
+        qint32 firstChild;
+        qint32 nextSibling;
+        qint32 term;           // term ending here, or -1
+        qint32 top[TopK];      // heaviest live terms below, -1 padded
+    };
+
+    // Each use is a term id and kind packed as id * KindCount + kind;
+    // terms met for the first time are created with no weight
+    QVector<int> usesFor(const Proverb &proverb);
+    void addUses(const QVector<int> &uses, int delta, bool refreshPaths = true);
+    int termFor(const QString &text);
+    int insertNode(int termId);
+    int newNode(int labelTerm, int start, int length, int parent);
+    int childStartingWith(int node, QChar c) const;
+    QStringView label(const Node &node) const;
+    bool heavier(int a, int b) const;
+    // Recomputes node's top list; true when its ancestors may need it too
+    bool refresh(int node, int changedTerm);
+    void refreshAll();
+
+    ChunkedVector<Node> nodes;
+    ChunkedVector<Term> terms;
+    ShardedHash<QString, int> termIds;
+    RowSlots rowSlots;
+    ChunkedVector<QVector<int>> slotUses;
+};
+
+#endif // COMPLETIONINDEX_H
@@ -0,0 +1,8 @@
+QT = core concurrent sql
+
+TARGET = fakra_core
+TEMPLATE = lib
+CONFIG += staticlib
+
+SOURCES += completionindex.cpp duplicateindex.cpp metrics.cpp phoneticindex.cpp proverbcollection.cpp proverbcolumns.cpp proverbdatabase.cpp proverbfacets.cpp proverbfilter.cpp proverbids.cpp proverbimporter.cpp proverbindex.cpp proverbjournal.cpp proverbranker.cpp proverbsnapshot.cpp proverbstore.cpp querycache.cpp rowbitmap.cpp rowslots.cpp termdictionary.cpp utf16search.cpp
+HEADERS += arenacolumn.h chunkedvector.h completionindex.h duplicateindex.h metrics.h phoneticindex.h proverb.h proverbbackend.h proverbcollection.h proverbcolumns.h proverbdatabase.h proverbfacets.h proverbfilter.h proverbids.h proverbimporter.h proverbindex.h proverbjournal.h proverbranker.h proverbsnapshot.h proverbstore.h querycache.h rowbitmap.h rowslots.h shardedhash.h termdictionary.h utf16search.h
@@ -0,0 +1,379 @@
+#include "duplicateindex.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "proverbindex.h"
+
+namespace {
+const int ShingleSize = 4;
+const float MinSimilarity = 0.5f;
+// Members of a large bucket are only compared with its first few
+const int PairLimit = 64;
+
+const quint64 FnvOffset = 14695981039346656037ull;
+const quint64 FnvPrime = 1099511628211ull;
+
+const char CacheMagic[4] = {'F', 'K', 'M', 'H'};
+const quint32 CacheVersion = 1;
+const quint32 ByteOrderMark = 0x01020304;
+
+struct CacheHeader {
+    char magic[4];
+    quint32 version;
+    quint32 hashCount;
+    quint32 byteOrder;
+    quint64 count;
+};
+
+struct CacheEntry {
+    quint64 id;
+    quint64 textHash;
+    quint16 values[DuplicateIndex::HashCount];
+};
+
+quint64 fnv(const QChar *data, qsizetype length, quint64 hash = FnvOffset)
+{
+    for (qsizetype i = 0; i < length; ++i) {
+        hash ^= data[i].unicode();
+        hash *= FnvPrime;
+    }
+    return hash;
+}
+
+quint64 mix(quint64 x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// Letters, digits and combining marks survive; everything else collapses
+// to one space, so punctuation and spacing variants shingle alike
+QString shingleText(QStringView text)
+{
+    QString normalized = ProverbIndex::normalize(text.toString());
+    QString result;
+    result.reserve(normalized.size());
+
+    bool space = true;
+    for (QChar c : normalized) {
+        if (c.isLetterOrNumber() || c.isMark()) {
+            result.append(c);
+            space = false;
+        } else if (!space) {
+            result.append(' ');
+            space = true;
+        }
+    }
+    if (result.endsWith(' ')) {
+        result.chop(1);
+    }
+    return result;
+}
+}
+
+DuplicateIndex::Signature DuplicateIndex::signature(QStringView proverb, QStringView transliteration)
+{
+    quint64 minima[HashCount];
+    std::fill(minima, minima + HashCount, ~quint64(0));
+
+    // Both fields feed one shingle set, so a romanized record still meets
+    // the transliteration of a Devanagari one
+    bool any = false;
+    for (const QString &text : {shingleText(proverb), shingleText(transliteration)}) {
+        qsizetype count = std::max<qsizetype>(1, text.size() - ShingleSize + 1);
+        for (qsizetype s = 0; s < count && !text.isEmpty(); ++s) {
+            quint64 shingle = fnv(text.constData() + s, std::min<qsizetype>(ShingleSize, text.size()));
+            for (int i = 0; i < HashCount; ++i) {
+                minima[i] = std::min(minima[i], mix(shingle ^ (0x9e3779b97f4a7c15ull * (i + 1))));
+            }
+            any = true;
+        }
+    }
+
+    Signature result;
+    if (!any) {
+        return result;
+    }
+
+    for (int i = 0; i < HashCount; ++i) {
+        result.values[i] = quint16(minima[i]);
+    }
+    result.textHash = textHash(proverb, transliteration);
+    return result;
+}
+
+void DuplicateIndex::build(const ProverbColumns &records, const QString &cachePath)
+{
+    clear();
+
+    QHash<quint64, Signature> cached;
+    if (!cachePath.isEmpty()) {
+        cached = readCache(cachePath);
+    }
+
+    QVector<int> stale;
+    signatures.reserve(records.size());
+    for (int row = 0; row < records.size(); ++row) {
+        auto it = cached.constFind(records.id(row));
+        if (it != cached.constEnd() &&
+            it->textHash == textHash(records.field(row, ProverbColumns::ProverbText),
+                                     records.field(row, ProverbColumns::Transliteration))) {
+            insert(records.id(row), it.value());
+        } else {
+            stale.append(row);
+        }
+    }
+
+    // Signatures are independent of each other, so the missing ones are
+    // computed across cores
+    QList<Signature> computed = QtConcurrent::blockingMapped(stale, [&records](int row) {
+        return signature(records.field(row, ProverbColumns::ProverbText),
+                         records.field(row, ProverbColumns::Transliteration));
+    });
+    for (int i = 0; i < stale.size(); ++i) {
+        insert(records.id(stale[i]), computed[i]);
+    }
+}
+
+void DuplicateIndex::clear()
+{
+    signatures.clear();
+    buckets.clear();
+}
+
+int DuplicateIndex::size() const
+{
+    return int(signatures.size());
+}
+
+void DuplicateIndex::insert(quint64 id, const Signature &signature)
+{
+    remove(id);
+
+    // Records without text would all collide, so they are left out
+    if (signature.textHash == 0) {
+        return;
+    }
+
+    signatures.insert(id, signature);
+    for (int band = 0; band < BandCount; ++band) {
+        buckets[bandKey(signature, band)].append(id);
+    }
+}
+
+void DuplicateIndex::remove(quint64 id)
+{
+    const Signature *old = std::as_const(signatures).find(id);
+    if (!old) {
+        return;
+    }
+
+    for (int band = 0; band < BandCount; ++band) {
+        quint64 key = bandKey(*old, band);
+        QVector<quint64> *bucket = buckets.find(key);
+        if (bucket) {
+            bucket->removeOne(id);
+            if (bucket->isEmpty()) {
+                buckets.remove(key);
+            }
+        }
+    }
+    signatures.remove(id);
+}
+
+QList<DuplicateIndex::Match> DuplicateIndex::candidates(const Signature &signature,
+                                                        quint64 excludeId) const
+{
+    QList<Match> matches;
+    if (signature.textHash == 0) {
+        return matches;
+    }
+
+    QSet<quint64> seen;
+    for (int band = 0; band < BandCount; ++band) {
+        const QVector<quint64> *bucket = buckets.find(bandKey(signature, band));
+        if (!bucket) {
+            continue;
+        }
+
+        for (quint64 id : *bucket) {
+            if (id == excludeId || seen.contains(id)) {
+                continue;
+            }
+            seen.insert(id);
+
+            // A shared band is only a hint; the full signature decides
+            float estimate = similarity(signature, signatures.value(id));
+            if (estimate >= MinSimilarity) {
+                matches.append(Match{id, estimate});
+            }
+        }
+    }
+
+    std::sort(matches.begin(), matches.end(), [](const Match &a, const Match &b) {
+        return a.similarity > b.similarity;
+    });
+    return matches;
+}
+
+QList<QList<quint64>> DuplicateIndex::duplicateGroups() const
+{
+    // Union-find over every similar pair that shares a bucket
+    QHash<quint64, quint64> parent;
+    auto find = [&parent](quint64 id) {
+        quint64 root = id;
+        while (parent.value(root, root) != root) {
+            root = parent.value(root);
+        }
+        while (id != root) {
+            quint64 next = parent.value(id, id);
+            parent[id] = root;
+            id = next;
+        }
+        return root;
+    };
+
+    buckets.forEach([&](quint64, const QVector<quint64> &bucket) {
+        for (int j = 1; j < bucket.size(); ++j) {
+            Signature b = signatures.value(bucket[j]);
+            for (int i = 0; i < std::min(j, PairLimit); ++i) {
+                if (similarity(signatures.value(bucket[i]), b) >= MinSimilarity) {
+                    quint64 rootA = find(bucket[i]);
+                    quint64 rootB = find(bucket[j]);
+                    if (rootA != rootB) {
+                        parent[rootB] = rootA;
+                    }
+                }
+            }
+        }
+    });
+
+    QHash<quint64, QList<quint64>> members;
+    const QList<quint64> linked = parent.keys();
+    for (quint64 id : linked) {
+        members[find(id)].append(id);
+    }
+
+    QList<QList<quint64>> groups;
+    for (auto it = members.begin(); it != members.end(); ++it) {
+        QList<quint64> &group = it.value();
+        if (!group.contains(it.key())) {
+            group.append(it.key());
+        }
+        std::sort(group.begin(), group.end());
+        groups.append(group);
+    }
+
+    std::sort(groups.begin(), groups.end(), [](const QList<quint64> &a, const QList<quint64> &b) {
+        return a.size() != b.size() ? a.size() > b.size() : a.first() < b.first();
+    });
+    return groups;
+}
+
+bool DuplicateIndex::save(const QString &path) const
+{
+    CacheHeader header;
+    std::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.version = CacheVersion;
+    header.hashCount = HashCount;
+    header.byteOrder = ByteOrderMark;
+    header.count = quint64(signatures.size());
+
+    QByteArray data;
+    data.reserve(qsizetype(sizeof(header) + signatures.size() * sizeof(CacheEntry)));
+    data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    signatures.forEach([&data](quint64 id, const Signature &signature) {
+        CacheEntry entry;
+        entry.id = id;
+        entry.textHash = signature.textHash;
+        std::memcpy(entry.values, signature.values, sizeof(entry.values));
+        data.append(reinterpret_cast<const char *>(&entry), sizeof(entry));
+    });
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    return file.write(data) == data.size() && file.commit();
+}
+
+quint64 DuplicateIndex::textHash(QStringView proverb, QStringView transliteration)
+{
+    const QChar separator(0x1f);
+    quint64 hash = fnv(proverb.data(), proverb.size());
+    hash = fnv(&separator, 1, hash);
+    hash = fnv(transliteration.data(), transliteration.size(), hash);
+    return hash ? hash : 1;
+}
+
+quint64 DuplicateIndex::bandKey(const Signature &signature, int band)
+{
+    quint64 key = FnvOffset ^ quint64(band);
+    for (int i = band * RowsPerBand; i < (band + 1) * RowsPerBand; ++i) {
+        key ^= signature.values[i];
+        key *= FnvPrime;
+    }
+    return key;
+}
+
+float DuplicateIndex::similarity(const Signature &a, const Signature &b)
+{
+    int equal = 0;
+    for (int i = 0; i < HashCount; ++i) {
+        equal += a.values[i] == b.values[i];
+    }
+    return float(equal) / HashCount;
+}
+
+QHash<quint64, DuplicateIndex::Signature> DuplicateIndex::readCache(const QString &path)
+{
+    QHash<quint64, Signature> cached;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return cached;
+    }
+
+    // A foreign, truncated or differently shaped cache is ignored
+    QByteArray data = file.readAll();
+    CacheHeader header;
+    if (data.size() < qsizetype(sizeof(header))) {
+        return cached;
+    }
+    std::memcpy(&header, data.constData(), sizeof(header));
+    if (std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) != 0 ||
+        header.version != CacheVersion ||
+        header.hashCount != quint32(HashCount) ||
+        header.byteOrder != ByteOrderMark) {
+        return cached;
+    }
+    // The count is checked against the entries' room before it is
+    // multiplied, so a corrupt one cannot overflow past the check
+    quint64 room = quint64(data.size()) - sizeof(header);
+    if (header.count > room / sizeof(CacheEntry) ||
+        room != header.count * sizeof(CacheEntry)) {
+        return cached;
+    }
+
+    cached.reserve(qsizetype(header.count));
+    const char *entries = data.constData() + sizeof(header);
+    for (quint64 i = 0; i < header.count; ++i) {
+        CacheEntry entry;
+        std::memcpy(&entry, entries + i * sizeof(CacheEntry), sizeof(entry));
+
+        Signature signature;
+        signature.textHash = entry.textHash;
+        std::memcpy(signature.values, entry.values, sizeof(signature.values));
+        cached.insert(entry.id, signature);
+    }
+    return cached;
+}
@@ -0,0 +1,70 @@
+#ifndef DUPLICATEINDEX_H
+#define DUPLICATEINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+#include "proverbcolumns.h"
+#include "shardedhash.h"
+
+// Finds near-duplicate proverbs with MinHash signatures and LSH buckets.
+// The normalized proverb and transliteration are cut into character
+// 4-gram shingles; a signature keeps the minimum of each of HashCount
+// hash functions over them, so the share of equal values estimates the
+// Jaccard similarity of two shingle sets. Signatures are split into
+// BandCount bands and records sharing any band land in one bucket, which
+// makes a lookup a handful of hash probes. With 16 bands of 2 rows the
+// chance of sharing a band rises steeply around a similarity of 0.25, so
+// nearly every pair at MinSimilarity (0.5) meets in some bucket (about
+// 99%) while unrelated records rarely do. Records are keyed by id, so
+// signatures survive row shifts and can be cached on disk.
+class DuplicateIndex {
+public:
+    static const int HashCount = 32;
+    static const int BandCount = 16;
+    static const int RowsPerBand = HashCount / BandCount;
+
+    struct Signature {
+        quint64 textHash = 0;           // of the text it was computed from, 0 for none
+        quint16 values[HashCount] = {};
+    };
+
+    struct Match {
+        quint64 id;
+        float similarity;               // estimated Jaccard similarity
+    };
+
+    static Signature signature(QStringView proverb, QStringView transliteration);
+
+    // Signatures cached at cachePath are reused for records whose text has
+    // not changed since; only the rest are computed, in parallel
+    void build(const ProverbColumns &records, const QString &cachePath = QString());
+    void clear();
+    int size() const;
+
+    void insert(quint64 id, const Signature &signature);
+    void remove(quint64 id);
+
+    // Indexed records likely to duplicate signature, most similar first
+    QList<Match> candidates(const Signature &signature, quint64 excludeId = 0) const;
+
+    // Groups of two or more ids that are near-duplicates of each other,
+    // largest group first
+    QList<QList<quint64>> duplicateGroups() const;
+
+    bool save(const QString &path) const;
+
+private:
+    static quint64 textHash(QStringView proverb, QStringView transliteration);
+    static quint64 bandKey(const Signature &signature, int band);
+    static float similarity(const Signature &a, const Signature &b);
+    static QHash<quint64, Signature> readCache(const QString &path);
+
+    ShardedHash<quint64, Signature> signatures;
+    ShardedHash<quint64, QVector<quint64>> buckets;
+};
+
+#endif // DUPLICATEINDEX_H
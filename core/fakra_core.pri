@@ -0,0 +1,12 @@
+# Links a subproject against the static fakra_core library
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+CORE_OUT = $$OUT_PWD/../core
+win32:CONFIG(release, debug|release): CORE_OUT = $$CORE_OUT/release
+else:win32:CONFIG(debug, debug|release): CORE_OUT = $$CORE_OUT/debug
+
+LIBS += -L$$CORE_OUT -lfakra_core
+
+win32-g++|!win32: PRE_TARGETDEPS += $$CORE_OUT/libfakra_core.a
+else: PRE_TARGETDEPS += $$CORE_OUT/fakra_core.lib
@@ -0,0 +1,255 @@
+#include "metrics.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QtAlgorithms>
+
+LatencyHistogram::LatencyHistogram(const QString &name)
+    : histogramName(name)
+{
+}
+
+void LatencyHistogram::record(qint64 nanos)
+{
+    quint64 value = nanos > 0 ? quint64(nanos) : 0;
+
+    buckets[bucketOf(value)].fetchAndAddRelaxed(1);
+    total.fetchAndAddRelaxed(1);
+    sum.fetchAndAddRelaxed(value);
+
+    quint64 seen = largest.loadRelaxed();
+    while (value > seen && !largest.testAndSetRelaxed(seen, value, seen)) {
+    }
+}
+
+QString LatencyHistogram::name() const
+{
+    return histogramName;
+}
+
+quint64 LatencyHistogram::count() const
+{
+    return total.loadRelaxed();
+}
+
+qint64 LatencyHistogram::percentile(double fraction) const
+{
+    // Counts are read without a lock, so sum the buckets instead of
+    // trusting total to agree with them
+    quint64 counts[BucketCount];
+    quint64 recorded = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        counts[i] = buckets[i].loadRelaxed();
+        recorded += counts[i];
+    }
+    if (recorded == 0) {
+        return 0;
+    }
+
+    quint64 rank = quint64(qBound(0.0, fraction, 1.0) * double(recorded - 1)) + 1;
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return qMin(bucketMidpoint(i), max());
+        }
+    }
+    return max();
+}
+
+qint64 LatencyHistogram::mean() const
+{
+    quint64 n = count();
+    return n > 0 ? qint64(sum.loadRelaxed() / n) : 0;
+}
+
+qint64 LatencyHistogram::max() const
+{
+    return qint64(largest.loadRelaxed());
+}
+
+QJsonObject LatencyHistogram::toJson() const
+{
+    auto ms = [](qint64 nanos) { return double(nanos) / 1e6; };
+
+    QJsonObject object;
+    object["count"] = qint64(count());
+    object["mean_ms"] = ms(mean());
+    object["p50_ms"] = ms(percentile(0.50));
+    object["p95_ms"] = ms(percentile(0.95));
+    object["p99_ms"] = ms(percentile(0.99));
+    object["max_ms"] = ms(max());
+    return object;
+}
+
+int LatencyHistogram::bucketOf(quint64 nanos)
+{
+    // Values below 16 get a bucket each; above that, the two bits after
+    // the leading one pick one of four sub-buckets per power of two
+    if (nanos < 16) {
+        return int(nanos);
+    }
+    int exponent = 63 - qCountLeadingZeroBits(nanos);
+    int sub = int(nanos >> (exponent - 2)) & (SubBuckets - 1);
+    return qMin(16 + (exponent - 4) * SubBuckets + sub, BucketCount - 1);
+}
+
+qint64 LatencyHistogram::bucketMidpoint(int bucket)
+{
+    if (bucket < 16) {
+        return bucket;
+    }
+    int exponent = (bucket - 16) / SubBuckets + 4;
+    int sub = (bucket - 16) % SubBuckets;
+    qint64 width = qint64(1) << (exponent - 2);
+    qint64 low = (qint64(1) << exponent) + sub * width;
+    return low + width / 2;
+}
+
+Metrics &Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::Metrics()
+    : tracePath(qEnvironmentVariable("FAKRA_TRACE"))
+{
+    clock.start();
+}
+
+Metrics::~Metrics()
+{
+    qDeleteAll(histograms);
+}
+
+LatencyHistogram &Metrics::histogram(const QString &name)
+{
+    QMutexLocker locker(&mutex);
+    for (LatencyHistogram *h : histograms) {
+        if (h->name() == name) {
+            return *h;
+        }
+    }
+    histograms.append(new LatencyHistogram(name));
+    return *histograms.last();
+}
+
+qint64 Metrics::now() const
+{
+    return clock.nsecsElapsed();
+}
+
+bool Metrics::tracing() const
+{
+    return !tracePath.isEmpty();
+}
+
+void Metrics::trace(const char *name, qint64 start, qint64 duration)
+{
+    // Complete ("X") events with microsecond timestamps
+    QByteArray event = "{\"name\":\"" + QByteArray(name) +
+                       "\",\"ph\":\"X\",\"ts\":" + QByteArray::number(double(start) / 1e3, 'f', 3) +
+                       ",\"dur\":" + QByteArray::number(double(duration) / 1e3, 'f', 3) +
+                       ",\"pid\":" + QByteArray::number(QCoreApplication::applicationPid()) +
+                       ",\"tid\":" + QByteArray::number(quint64(quintptr(QThread::currentThreadId()))) + "}";
+
+    // Once full, the newest event overwrites the oldest
+    QMutexLocker locker(&mutex);
+    if (traceEvents.size() < TraceCapacity) {
+        traceEvents.append(event);
+    } else {
+        traceEvents[nextTrace] = event;
+        nextTrace = (nextTrace + 1) % TraceCapacity;
+    }
+}
+
+bool Metrics::writeTrace() const
+{
+    if (!tracing()) {
+        return true;
+    }
+
+    QMutexLocker locker(&mutex);
+    QSaveFile file(tracePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    // Oldest first: the ring wraps at nextTrace
+    file.write("{\"traceEvents\":[\n");
+    for (int i = 0; i < traceEvents.size(); ++i) {
+        file.write(traceEvents[(nextTrace + i) % traceEvents.size()]);
+        file.write(i + 1 < traceEvents.size() ? ",\n" : "\n");
+    }
+    file.write("],\"displayTimeUnit\":\"ms\"}\n");
+    return file.commit();
+}
+
+QJsonObject Metrics::toJson() const
+{
+    QJsonObject scopes;
+    {
+        QMutexLocker locker(&mutex);
+        for (const LatencyHistogram *h : histograms) {
+            scopes[h->name()] = h->toJson();
+        }
+    }
+
+    QJsonObject object;
+    object["captured_at"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    object["uptime_ms"] = double(now()) / 1e6;
+    object["scopes"] = scopes;
+    return object;
+}
+
+bool Metrics::writeJson(const QString &path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(toJson()).toJson());
+    return file.commit();
+}
+
+void Metrics::markStartupBegin()
+{
+    startupBegin = now();
+}
+
+void Metrics::markStartupEnd()
+{
+    if (startupBegin < 0) {
+        return;
+    }
+
+    qint64 duration = now() - startupBegin;
+    histogram("startup").record(duration);
+    if (tracing()) {
+        trace("startup", startupBegin, duration);
+    }
+    startupBegin = -1;
+}
+
+ScopedTimer::ScopedTimer(LatencyHistogram &histogram, const char *name)
+    : histogram(histogram),
+    name(name),
+    start(Metrics::instance().now())
+{
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    Metrics &metrics = Metrics::instance();
+    qint64 duration = metrics.now() - start;
+    histogram.record(duration);
+    if (metrics.tracing()) {
+        metrics.trace(name, start, duration);
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+// Latency histogram safe to record into from any thread without locking.
+// Buckets are log-linear, four per power of two, so a percentile is
+// accurate to within a quarter of its power of two.
+class LatencyHistogram {
+public:
+    explicit LatencyHistogram(const QString &name);
+
+    void record(qint64 nanos);
+
+    QString name() const;
+    quint64 count() const;
+    // Nanosecond value below which fraction (0..1) of recordings fall
+    qint64 percentile(double fraction) const;
+    qint64 mean() const;
+    qint64 max() const;
+
+    QJsonObject toJson() const;
+
+private:
+    static const int SubBuckets = 4;
+    static const int BucketCount = 16 + 60 * SubBuckets;
+
+    static int bucketOf(quint64 nanos);
+    static qint64 bucketMidpoint(int bucket);
+
+    QString histogramName;
+    QAtomicInteger<quint64> buckets[BucketCount];
+    QAtomicInteger<quint64> total;
+    QAtomicInteger<quint64> sum;
+    QAtomicInteger<quint64> largest;
+};
+
+// Process-wide registry of histograms plus the optional Chrome trace.
+// Setting FAKRA_TRACE=<file> records every timed scope as a trace event,
+// written to that file by writeTrace() in the chrome://tracing format.
+class Metrics {
+public:
+    static Metrics &instance();
+
+    // Registers on first use; later calls for the same name share it
+    LatencyHistogram &histogram(const QString &name);
+
+    // Monotonic nanoseconds since the registry was created
+    qint64 now() const;
+
+    bool tracing() const;
+    void trace(const char *name, qint64 start, qint64 duration);
+    bool writeTrace() const;
+
+    QJsonObject toJson() const;
+    bool writeJson(const QString &path) const;
+
+    // Startup spans from markStartupBegin() in main() to the first paint
+    void markStartupBegin();
+    void markStartupEnd();
+
+private:
+    Metrics();
+    ~Metrics();
+
+    QElapsedTimer clock;
+    mutable QMutex mutex;
+    QList<LatencyHistogram *> histograms;
+    // Trace events kept for writeTrace(), at most TraceCapacity of them
+    static const int TraceCapacity = 100000;
+    QString tracePath;
+    QList<QByteArray> traceEvents;
+    int nextTrace = 0;
+    qint64 startupBegin = -1;
+};
+
+// Records the lifetime of a scope into a histogram and, when tracing, the trace
+class ScopedTimer {
+public:
+    ScopedTimer(LatencyHistogram &histogram, const char *name);
+    ~ScopedTimer();
+
+private:
+    LatencyHistogram &histogram;
+    const char *name;
+    qint64 start;
+};
+
+#define FAKRA_CONCAT_(a, b) a##b
+#define FAKRA_CONCAT(a, b) FAKRA_CONCAT_(a, b)
+
+// Times the enclosing scope. The histogram is looked up once per call site.
+#define FAKRA_TIMED_SCOPE(name) \
+    static LatencyHistogram &FAKRA_CONCAT(fakraHistogram, __LINE__) = Metrics::instance().histogram(name); \
+    ScopedTimer FAKRA_CONCAT(fakraTimer, __LINE__)(FAKRA_CONCAT(fakraHistogram, __LINE__), name)
+
+#endif // METRICS_H
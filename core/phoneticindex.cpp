@@ -0,0 +1,361 @@
+#include "phoneticindex.h"
+
+#include "proverbindex.h"
+#include "proverbranker.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+enum LetterKind {
+    Vowel,        // independent vowel
+    VowelSign,    // dependent vowel replacing the inherent a
+    Consonant,    // carries an inherent a unless a sign or virama follows
+    Virama,
+    Nukta,
+    Other         // anusvara, visarga, digits
+};
+
+struct Letter {
+    char16_t code;
+    LetterKind kind;
+    const char *iso;   // UTF-8
+};
+
+// Devanagari to ISO-15919. Anusvara and candrabindu are written n, as
+// everyday romanization does, instead of ISO's ṁ and m̐.
+const Letter Letters[] = {
+    {0x0901, Other, "n"}, {0x0902, Other, "n"}, {0x0903, Other, "ḥ"},
+    {0x0905, Vowel, "a"}, {0x0906, Vowel, "ā"}, {0x0907, Vowel, "i"}, {0x0908, Vowel, "ī"},
+    {0x0909, Vowel, "u"}, {0x090A, Vowel, "ū"}, {0x090B, Vowel, "r̥"}, {0x090C, Vowel, "l̥"},
+    {0x090D, Vowel, "ê"}, {0x090F, Vowel, "ē"}, {0x0910, Vowel, "ai"}, {0x0911, Vowel, "ô"},
+    {0x0913, Vowel, "ō"}, {0x0914, Vowel, "au"}, {0x0960, Vowel, "r̥̄"}, {0x0961, Vowel, "l̥̄"},
+    {0x0915, Consonant, "k"}, {0x0916, Consonant, "kh"}, {0x0917, Consonant, "g"},
+    {0x0918, Consonant, "gh"}, {0x0919, Consonant, "ṅ"},
+    {0x091A, Consonant, "c"}, {0x091B, Consonant, "ch"}, {0x091C, Consonant, "j"},
+    {0x091D, Consonant, "jh"}, {0x091E, Consonant, "ñ"},
+    {0x091F, Consonant, "ṭ"}, {0x0920, Consonant, "ṭh"}, {0x0921, Consonant, "ḍ"},
+    {0x0922, Consonant, "ḍh"}, {0x0923, Consonant, "ṇ"},
+    {0x0924, Consonant, "t"}, {0x0925, Consonant, "th"}, {0x0926, Consonant, "d"},
+    {0x0927, Consonant, "dh"}, {0x0928, Consonant, "n"},
+    {0x092A, Consonant, "p"}, {0x092B, Consonant, "ph"}, {0x092C, Consonant, "b"},
+    {0x092D, Consonant, "bh"}, {0x092E, Consonant, "m"},
+    {0x092F, Consonant, "y"}, {0x0930, Consonant, "r"}, {0x0932, Consonant, "l"},
+    {0x0933, Consonant, "ḷ"}, {0x0935, Consonant, "v"},
+    {0x0936, Consonant, "ś"}, {0x0937, Consonant, "ṣ"}, {0x0938, Consonant, "s"},
+    {0x0939, Consonant, "h"},
+    // Precomposed nukta letters, in case a caller skips normalization
+    {0x0958, Consonant, "q"}, {0x0959, Consonant, "k͟h"}, {0x095A, Consonant, "ġ"},
+    {0x095B, Consonant, "z"}, {0x095C, Consonant, "ṛ"}, {0x095D, Consonant, "ṛh"},
+    {0x095E, Consonant, "f"}, {0x095F, Consonant, "ẏ"},
+    {0x093E, VowelSign, "ā"}, {0x093F, VowelSign, "i"}, {0x0940, VowelSign, "ī"},
+    {0x0941, VowelSign, "u"}, {0x0942, VowelSign, "ū"}, {0x0943, VowelSign, "r̥"},
+    {0x0944, VowelSign, "r̥̄"}, {0x0962, VowelSign, "l̥"}, {0x0945, VowelSign, "ê"},
+    {0x0947, VowelSign, "ē"}, {0x0948, VowelSign, "ai"}, {0x0949, VowelSign, "ô"},
+    {0x094B, VowelSign, "ō"}, {0x094C, VowelSign, "au"},
+    {0x094D, Virama, ""}, {0x093C, Nukta, ""},
+    {0x0966, Other, "0"}, {0x0967, Other, "1"}, {0x0968, Other, "2"}, {0x0969, Other, "3"},
+    {0x096A, Other, "4"}, {0x096B, Other, "5"}, {0x096C, Other, "6"}, {0x096D, Other, "7"},
+    {0x096E, Other, "8"}, {0x096F, Other, "9"}
+};
+
+// A consonant followed by a nukta stands for a borrowed sound
+const Letter NuktaLetters[] = {
+    {0x0915, Consonant, "q"}, {0x0916, Consonant, "k͟h"}, {0x0917, Consonant, "ġ"},
+    {0x091C, Consonant, "z"}, {0x0921, Consonant, "ṛ"}, {0x0922, Consonant, "ṛh"},
+    {0x092B, Consonant, "f"}, {0x092F, Consonant, "ẏ"}
+};
+
+struct LetterTable {
+    QHash<char16_t, const Letter *> letters;
+    QHash<char16_t, QString> nukta;
+
+    LetterTable()
+    {
+        for (const Letter &letter : Letters) {
+            letters.insert(letter.code, &letter);
+        }
+        for (const Letter &letter : NuktaLetters) {
+            nukta.insert(letter.code, QString::fromUtf8(letter.iso));
+        }
+    }
+};
+
+const LetterTable &letterTable()
+{
+    static const LetterTable table;
+    return table;
+}
+
+// One transliterated letter; consonants remember whether they still
+// sound their inherent a
+struct Unit {
+    char16_t source;
+    LetterKind kind;
+    QString text;
+    bool inherent;
+};
+
+bool sounded(const Unit &unit)
+{
+    return unit.kind == Vowel || unit.kind == VowelSign || (unit.kind == Consonant && unit.inherent);
+}
+
+bool isLatinVowel(QChar c)
+{
+    return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u';
+}
+}
+
+void PhoneticIndex::build(const QList<Proverb> &proverbs)
+{
+    clear();
+    slotKeys.reserve(proverbs.size());
+
+    for (const Proverb &p : proverbs) {
+        append(p);
+    }
+}
+
+void PhoneticIndex::clear()
+{
+    rowSlots.clear();
+    postings.clear();
+    slotKeys.clear();
+}
+
+void PhoneticIndex::append(const Proverb &proverb)
+{
+    int slot = rowSlots.append();
+    slotKeys.append(keysFor(proverb));
+
+    for (const QString &k : slotKeys.last()) {
+        postings[k].append(slot);
+    }
+}
+
+void PhoneticIndex::update(int row, const Proverb &proverb)
+{
+    if (row < 0 || row >= rowSlots.size()) {
+        return;
+    }
+
+    int slot = rowSlots.slotOf(row);
+    removePostings(slot);
+    slotKeys[slot] = keysFor(proverb);
+    for (const QString &k : slotKeys.at(slot)) {
+        QVector<int> &list = postings[k];
+        list.insert(std::lower_bound(list.begin(), list.end(), slot), slot);
+    }
+}
+
+void PhoneticIndex::remove(int row)
+{
+    if (row < 0 || row >= rowSlots.size()) {
+        return;
+    }
+
+    // Later records keep their slots, so no other posting changes
+    int slot = rowSlots.remove(row);
+    removePostings(slot);
+    slotKeys[slot] = QVector<QString>();
+
+    if (rowSlots.wantsCompaction()) {
+        compact();
+    }
+}
+
+QVector<int> PhoneticIndex::rows(const QString &query) const
+{
+    QVector<int> result;
+    bool first = true;
+
+    for (const QString &word : ProverbRanker::tokenize(ProverbIndex::normalize(query))) {
+        QString k = key(word);
+        if (k.isEmpty()) {
+            continue;
+        }
+
+        const QVector<int> *list = postings.find(k);
+        if (!list) {
+            return QVector<int>();
+        }
+
+        if (first) {
+            result = *list;
+            first = false;
+        } else {
+            QVector<int> scratch;
+            std::set_intersection(result.cbegin(), result.cend(),
+                                  list->cbegin(), list->cend(),
+                                  std::back_inserter(scratch));
+            result.swap(scratch);
+        }
+
+        if (result.isEmpty()) {
+            break;
+        }
+    }
+
+    return rowSlots.toRows(result);
+}
+
+void PhoneticIndex::removePostings(int slot)
+{
+    for (const QString &k : slotKeys.at(slot)) {
+        QVector<int> *list = postings.find(k);
+        if (!list) {
+            continue;
+        }
+        auto pos = std::lower_bound(list->begin(), list->end(), slot);
+        if (pos != list->end() && *pos == slot) {
+            list->erase(pos);
+        }
+        if (list->isEmpty()) {
+            postings.remove(k);
+        }
+    }
+}
+
+void PhoneticIndex::compact()
+{
+    const QVector<int> renumbered = rowSlots.compact();
+    postings.forEachMutable([&renumbered](const QString &, QVector<int> &list) {
+        RowSlots::renumber(list, renumbered);
+    });
+    slotKeys = RowSlots::keepLive(slotKeys, renumbered);
+}
+
+QString PhoneticIndex::key(const QString &word)
+{
+    return fold(toIso15919(word));
+}
+
+QString PhoneticIndex::toIso15919(const QString &word)
+{
+    const LetterTable &table = letterTable();
+
+    QVector<Unit> units;
+    units.reserve(word.size());
+
+    for (QChar ch : word) {
+        const Letter *letter = table.letters.value(ch.unicode());
+        if (!letter) {
+            units.append({ch.unicode(), Other, QString(ch), false});
+            continue;
+        }
+
+        bool afterConsonant = !units.isEmpty() && units.last().kind == Consonant;
+        switch (letter->kind) {
+        case Nukta:
+            if (afterConsonant && table.nukta.contains(units.last().source)) {
+                units.last().text = table.nukta.value(units.last().source);
+            }
+            break;
+        case Virama:
+            if (afterConsonant) {
+                units.last().inherent = false;
+            }
+            break;
+        case VowelSign:
+            if (afterConsonant) {
+                units.last().inherent = false;
+            }
+            units.append({letter->code, VowelSign, QString::fromUtf8(letter->iso), false});
+            break;
+        default:
+            units.append({letter->code, letter->kind, QString::fromUtf8(letter->iso),
+                          letter->kind == Consonant});
+            break;
+        }
+    }
+
+    // Schwa deletion, right to left: a final inherent a is silent, and so is
+    // one between a sounded letter and a consonant that has its own vowel
+    // (रहना is rahnā, not rahanā)
+    for (int i = units.size() - 1; i > 0; --i) {
+        Unit &unit = units[i];
+        if (unit.kind != Consonant || !unit.inherent) {
+            continue;
+        }
+
+        if (i == units.size() - 1) {
+            unit.inherent = false;
+        } else if (sounded(units[i - 1]) && units[i + 1].kind == Consonant &&
+                   (units[i + 1].inherent || (i + 2 < units.size() && sounded(units[i + 2])))) {
+            unit.inherent = false;
+        }
+    }
+
+    QString iso;
+    for (const Unit &unit : units) {
+        iso += unit.text;
+        if (unit.kind == Consonant && unit.inherent) {
+            iso += 'a';
+        }
+    }
+    return iso;
+}
+
+QVector<QString> PhoneticIndex::keysFor(const Proverb &proverb)
+{
+    QStringList words = ProverbRanker::tokenize(ProverbIndex::normalize(proverb.proverb));
+    words += ProverbRanker::tokenize(ProverbIndex::normalize(proverb.transliteration));
+
+    QVector<QString> keys;
+    for (const QString &word : words) {
+        QString k = key(word);
+        if (!k.isEmpty()) {
+            keys.append(k);
+        }
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+QString PhoneticIndex::fold(const QString &latin)
+{
+    // Strip diacritics: ā, ṭ, ṛ, ś and friends become their base letter
+    QString stripped;
+    const QString decomposed = latin.normalized(QString::NormalizationForm_D).toCaseFolded();
+    for (QChar ch : decomposed) {
+        if (!ch.isMark()) {
+            stripped += ch;
+        }
+    }
+
+    // Long vowels as romanized in English spelling
+    stripped.replace("ee", "i");
+    stripped.replace("oo", "u");
+
+    QString key;
+    key.reserve(stripped.size());
+    for (QChar ch : stripped) {
+        // Variant letters for the same sound
+        switch (ch.unicode()) {
+        case 'w': ch = QChar('v'); break;
+        case 'z': ch = QChar('j'); break;
+        case 'f': ch = QChar('p'); break;
+        case 'q': ch = QChar('k'); break;
+        default: break;
+        }
+
+        if (!key.isEmpty()) {
+            QChar previous = key.back();
+            // Aspiration is spelled inconsistently (chh, ch, c), so h after
+            // a consonant is dropped
+            if (ch == 'h' && previous.isLetter() && !isLatinVowel(previous)) {
+                continue;
+            }
+            // Vowel length and gemination collapse to a single letter
+            if (ch == previous) {
+                continue;
+            }
+        }
+        key += ch;
+    }
+
+    return key;
+}
@@ -0,0 +1,48 @@
+#ifndef PHONETICINDEX_H
+#define PHONETICINDEX_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "chunkedvector.h"
+#include "proverb.h"
+#include "rowslots.h"
+#include "shardedhash.h"
+
+// Maps the words of the proverb and transliteration fields to phonetic keys
+// shared by Devanagari and romanized spellings, so "barhi" finds बाढ़ि.
+// Devanagari is first transliterated to ISO-15919 through a fixed table;
+// that and any Latin input are then folded the same way: diacritics,
+// aspiration, vowel length and doubled letters are dropped and common
+// variant letters merged. Rows follow the collection like ProverbIndex,
+// and are likewise kept by slot inside.
+class PhoneticIndex {
+public:
+    void build(const QList<Proverb> &proverbs);
+    void clear();
+
+    void append(const Proverb &proverb);
+    void update(int row, const Proverb &proverb);
+    void remove(int row);
+
+    // Sorted rows holding a word with the same key as every query word.
+    // Each word costs one hash probe; the corpus is never rescanned.
+    QVector<int> rows(const QString &query) const;
+
+    // Key of a single normalized word, in either script
+    static QString key(const QString &word);
+    static QString toIso15919(const QString &word);
+
+private:
+    static QVector<QString> keysFor(const Proverb &proverb);
+    static QString fold(const QString &latin);
+    void removePostings(int slot);
+    void compact();
+
+    RowSlots rowSlots;
+    ShardedHash<QString, QVector<int>> postings;    // sorted slots
+    ChunkedVector<QVector<QString>> slotKeys;
+};
+
+#endif // PHONETICINDEX_H
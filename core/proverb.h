@@ -0,0 +1,70 @@
+#ifndef PROVERB_H
+#define PROVERB_H
+
+#include <QString>
+#include <QStringList>
+#include <QJsonArray>
+#include <QJsonObject>
+
+// Proverb structure definition
+struct Proverb {
+    quint64 id = 0;     // stable across edits, 0 until assigned
+    QString proverb;
+    QString transliteration;
+    QString meaning;
+    QString englishEquivalent;
+    QStringList tags;
+    QString region;
+    QString usageContext;
+
+    QJsonObject toJson() const {
+        QJsonObject obj;
+        obj["id"] = qint64(id);
+        obj["proverb"] = proverb;
+        obj["transliteration"] = transliteration;
+        obj["meaning"] = meaning;
+        obj["english_equivalent"] = englishEquivalent;
+
+        QJsonArray tagsArray;
+        for (const QString &tag : tags) {
+            tagsArray.append(tag);
+        }
+        obj["tags"] = tagsArray;
+
+        obj["region"] = region;
+        obj["usage_context"] = usageContext;
+        return obj;
+    }
+
+    // Tags as typed in the editor: comma separated, surrounding spaces ignored
+    static QStringList splitTags(const QString &text) {
+        QStringList tags;
+        for (const QString &tag : text.split(",", Qt::SkipEmptyParts)) {
+            QString trimmed = tag.trimmed();
+            if (!trimmed.isEmpty()) {
+                tags.append(trimmed);
+            }
+        }
+        return tags;
+    }
+
+    static Proverb fromJson(const QJsonObject &obj) {
+        Proverb p;
+        p.id = quint64(obj["id"].toInteger());
+        p.proverb = obj["proverb"].toString();
+        p.transliteration = obj["transliteration"].toString();
+        p.meaning = obj["meaning"].toString();
+        p.englishEquivalent = obj["english_equivalent"].toString();
+
+        QJsonArray tagsArray = obj["tags"].toArray();
+        for (const QJsonValue &tag : tagsArray) {
+            p.tags.append(tag.toString());
+        }
+
+        p.region = obj["region"].toString();
+        p.usageContext = obj["usage_context"].toString();
+        return p;
+    }
+};
+
+#endif // PROVERB_H
@@ -0,0 +1,44 @@
+#ifndef PROVERBBACKEND_H
+#define PROVERBBACKEND_H
+
+#include <QFuture>
+#include <QList>
+
+#include "proverb.h"
+#include "proverbcolumns.h"
+#include "proverbsnapshot.h"
+
+// Where the collection is stored. The store in memory is the working
+// copy: load() fills it once, each change is then appended as it is made,
+// and the write calls bring the stored copy in step with changes made
+// without them.
+class ProverbBackend {
+public:
+    virtual ~ProverbBackend() = default;
+
+    // Appends the stored records to proverbs. Returns false when there is
+    // no stored collection yet.
+    virtual bool load(QList<Proverb> &proverbs) = 0;
+
+    // Mappings the strings from load() may point into
+    virtual MappedSnapshots mappedSnapshots() const { return MappedSnapshots(); }
+
+    // An id after every one the stored collection has held, deleted records
+    // included, for a record about to be added
+    virtual quint64 nextId() = 0;
+
+    virtual bool appendAdd(const Proverb &proverb) = 0;
+    virtual bool appendEdit(const Proverb &proverb) = 0;
+    virtual bool appendRemove(quint64 id) = 0;
+
+    // For changes made without the append calls, like a bulk import: the
+    // rows from firstRow on are written by the next write, and from row 0
+    // the whole collection is
+    virtual void markDirty(const ProverbColumns &proverbs, int firstRow = 0) = 0;
+
+    // The async write works on an implicitly shared copy of the columns
+    virtual bool writeSnapshot(const ProverbColumns &proverbs) = 0;
+    virtual QFuture<bool> writeSnapshotAsync(const ProverbColumns &proverbs) = 0;
+};
+
+#endif // PROVERBBACKEND_H
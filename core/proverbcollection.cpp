@@ -0,0 +1,371 @@
+#include "proverbcollection.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <utility>
+
+#include "proverbids.h"
+
+namespace {
+const char *const ManifestName = "manifest.json";
+}
+
+ProverbCollection::ProverbCollection(const QString &directory, Sharding sharding, int hashShards)
+    : directory(directory),
+    sharding(sharding),
+    hashShards(qMax(1, hashShards))
+{
+    startNew();
+}
+
+bool ProverbCollection::exists(const QString &directory)
+{
+    return QFile::exists(QDir(directory).filePath(ManifestName));
+}
+
+bool ProverbCollection::load(QList<Proverb> &proverbs)
+{
+    return load(proverbs, ProverbJournal::ReadWrite);
+}
+
+bool ProverbCollection::load(QList<Proverb> &proverbs, ProverbJournal::LoadMode mode)
+{
+    waitForWrites();
+    owners.clear();
+    dirty.clear();
+
+    if (!readManifest()) {
+        startNew();
+        return false;
+    }
+
+    // Every shard is its own set of files, so they load side by side
+    QList<QList<Proverb>> loaded = QtConcurrent::blockingMapped(shards, [mode](const Shard &shard) {
+        QList<Proverb> records;
+        shard.journal->load(records, mode);
+        return records;
+    });
+
+    int first = int(proverbs.size());
+    QHash<quint64, int> seen;
+    for (int i = 0; i < loaded.size(); ++i) {
+        for (Proverb &proverb : loaded[i]) {
+            // A move between region shards cut short by a crash can leave
+            // the record in both, identical; one copy is enough
+            auto it = seen.constFind(proverb.id);
+            if (it != seen.constEnd() && proverbs.at(it.value()).toJson() == proverb.toJson()) {
+                dirty.insert(i);
+                continue;
+            }
+            seen.insert(proverb.id, int(proverbs.size()));
+
+            // Found where the scheme no longer puts it, e.g. edited into
+            // another region just before a crash
+            int owner = shardFor(proverb.id, proverb.region);
+            if (owner != i) {
+                dirty.insert(i);
+                dirty.insert(owner);
+            }
+            proverbs.append(std::move(proverb));
+        }
+    }
+
+    // Shards number records without an id on their own, so ids can clash
+    // across them; renumbered, every record may belong elsewhere
+    QList<Proverb> records = proverbs.mid(first);
+    if (ProverbIdIndex::assignMissing(records) > 0) {
+        for (int i = 0; i < shards.size(); ++i) {
+            dirty.insert(i);
+        }
+        for (int row = 0; row < records.size(); ++row) {
+            proverbs[first + row].id = records.at(row).id;
+        }
+    }
+
+    if (sharding == ByRegion) {
+        owners.reserve(int(records.size()));
+        for (const Proverb &proverb : std::as_const(records)) {
+            owners.insert(proverb.id, shardFor(proverb.id, proverb.region));
+        }
+    }
+
+    if (mode == ProverbJournal::ReadWrite && !dirty.isEmpty()) {
+        writeSnapshot(ProverbColumns::fromList(records));
+    }
+    return true;
+}
+
+MappedSnapshots ProverbCollection::mappedSnapshots() const
+{
+    MappedSnapshots snapshots;
+    for (const Shard &shard : shards) {
+        if (shard.journal->mappedSnapshot()) {
+            snapshots.append(shard.journal->mappedSnapshot());
+        }
+    }
+    return snapshots;
+}
+
+quint64 ProverbCollection::nextId()
+{
+    quint64 next = 1;
+    for (const Shard &shard : std::as_const(shards)) {
+        next = std::max(next, shard.journal->nextId());
+    }
+    return next;
+}
+
+bool ProverbCollection::appendAdd(const Proverb &proverb)
+{
+    int shard = shardFor(proverb.id, proverb.region);
+    if (!ensureManifest()) {
+        return false;
+    }
+
+    dirty.insert(shard);
+    if (sharding == ByRegion) {
+        owners.insert(proverb.id, shard);
+    }
+    return shards.at(shard).journal->appendAdd(proverb);
+}
+
+bool ProverbCollection::appendEdit(const Proverb &proverb)
+{
+    int from = ownerOf(proverb.id);
+    if (from < 0) {
+        return appendAdd(proverb);
+    }
+    int to = shardFor(proverb.id, proverb.region);
+    if (!ensureManifest()) {
+        return false;
+    }
+
+    dirty.insert(from);
+    if (from == to) {
+        return shards.at(to).journal->appendEdit(proverb);
+    }
+
+    // Moved to another region's shard. A crash part way leaves the edited
+    // record misplaced in the old shard, or identical in both, and load()
+    // recovers from either.
+    dirty.insert(to);
+    owners.insert(proverb.id, to);
+    bool ok = shards.at(from).journal->appendEdit(proverb);
+    ok = shards.at(to).journal->appendAdd(proverb) && ok;
+    return shards.at(from).journal->appendRemove(proverb.id) && ok;
+}
+
+bool ProverbCollection::appendRemove(quint64 id)
+{
+    int shard = ownerOf(id);
+    if (shard < 0 || !ensureManifest()) {
+        return false;
+    }
+
+    dirty.insert(shard);
+    owners.remove(id);
+    return shards.at(shard).journal->appendRemove(id);
+}
+
+void ProverbCollection::markDirty(const ProverbColumns &proverbs, int firstRow)
+{
+    if (firstRow <= 0) {
+        // Also empties shards none of the rows belong to any more
+        for (int i = 0; i < shards.size(); ++i) {
+            dirty.insert(i);
+        }
+        if (sharding == ByHash) {
+            return;
+        }
+        owners.clear();
+        firstRow = 0;
+    }
+
+    for (int row = firstRow; row < proverbs.size(); ++row) {
+        int shard = shardFor(proverbs.id(row), proverbs.field(row, ProverbColumns::Region));
+        if (sharding == ByRegion) {
+            owners.insert(proverbs.id(row), shard);
+        }
+        dirty.insert(shard);
+    }
+}
+
+bool ProverbCollection::writeSnapshot(const ProverbColumns &proverbs)
+{
+    if (!ensureManifest()) {
+        return false;
+    }
+
+    bool ok = true;
+    for (int shard : std::as_const(dirty)) {
+        ok = shards.at(shard).journal->writeSnapshot(proverbs, rowsOf(shard)) && ok;
+    }
+    dirty.clear();
+    return ok;
+}
+
+QFuture<bool> ProverbCollection::writeSnapshotAsync(const ProverbColumns &proverbs)
+{
+    if (!ensureManifest()) {
+        return QtConcurrent::run([]() { return false; });
+    }
+
+    // Untouched shards keep their files as they are
+    QList<QFuture<bool>> writes;
+    for (int shard : std::as_const(dirty)) {
+        writes.append(shards.at(shard).journal->writeSnapshotAsync(proverbs, rowsOf(shard)));
+    }
+    dirty.clear();
+
+    return QtFuture::whenAll(writes.begin(), writes.end()).then([](const QList<QFuture<bool>> &done) {
+        bool ok = true;
+        for (const QFuture<bool> &write : done) {
+            ok = write.result() && ok;
+        }
+        return ok;
+    });
+}
+
+void ProverbCollection::waitForWrites()
+{
+    for (const Shard &shard : std::as_const(shards)) {
+        shard.journal->waitForCompaction();
+    }
+}
+
+int ProverbCollection::hashShard(quint64 id, int count)
+{
+    // Mixed first, since ids are handed out in sequence
+    return int(((id * 0x9e3779b97f4a7c15ull) >> 32) % quint64(count));
+}
+
+void ProverbCollection::startNew()
+{
+    // Nothing reaches the disk until the first record or save
+    shards.clear();
+    regionShards.clear();
+    for (int i = 0; sharding == ByHash && i < hashShards; ++i) {
+        addShard(QString());
+    }
+}
+
+bool ProverbCollection::readManifest()
+{
+    QFile file(QDir(directory).filePath(ManifestName));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonObject manifest = QJsonDocument::fromJson(file.readAll()).object();
+    sharding = manifest["sharding"].toString() == "region" ? ByRegion : ByHash;
+    shards.clear();
+    regionShards.clear();
+    for (const QJsonValue &value : manifest["shards"].toArray()) {
+        QJsonObject entry = value.toObject();
+        Shard shard;
+        shard.file = entry["file"].toString();
+        shard.region = entry["region"].toString();
+        shard.journal.reset(new ProverbJournal(QDir(directory).filePath(shard.file)));
+        if (sharding == ByRegion) {
+            regionShards.insert(shard.region, int(shards.size()));
+        }
+        shards.append(shard);
+    }
+
+    manifestWritten = true;
+    return sharding == ByRegion || !shards.isEmpty();
+}
+
+bool ProverbCollection::ensureManifest()
+{
+    if (manifestWritten) {
+        return true;
+    }
+
+    QJsonArray entries;
+    for (const Shard &shard : std::as_const(shards)) {
+        QJsonObject entry;
+        entry["file"] = shard.file;
+        if (sharding == ByRegion) {
+            entry["region"] = shard.region;
+        }
+        entries.append(entry);
+    }
+
+    QJsonObject manifest;
+    manifest["version"] = 1;
+    manifest["sharding"] = sharding == ByRegion ? "region" : "hash";
+    manifest["shards"] = entries;
+
+    // Written before anything reaches a new shard, so no shard's files
+    // are ever left out of it
+    QByteArray data = QJsonDocument(manifest).toJson();
+    QSaveFile file(QDir(directory).filePath(ManifestName));
+    manifestWritten = QDir().mkpath(directory) && file.open(QIODevice::WriteOnly) &&
+                      file.write(data) == data.size() && file.commit();
+    return manifestWritten;
+}
+
+int ProverbCollection::addShard(const QString &region)
+{
+    QDir dir(directory);
+    Shard shard;
+    shard.region = region;
+    if (sharding == ByHash) {
+        shard.file = QString("shard-%1.json").arg(shards.size(), 2, 10, QLatin1Char('0'));
+    } else {
+        // Files left by a shard that never made it into the manifest are
+        // not reused
+        int number = int(shards.size());
+        do {
+            shard.file = QString("region-%1.json").arg(number++);
+        } while (dir.exists(shard.file) || dir.exists(shard.file + ".journal"));
+        regionShards.insert(region, int(shards.size()));
+    }
+    shard.journal.reset(new ProverbJournal(dir.filePath(shard.file)));
+
+    shards.append(shard);
+    manifestWritten = false;
+    return int(shards.size()) - 1;
+}
+
+int ProverbCollection::shardFor(quint64 id, QStringView region)
+{
+    if (sharding == ByHash) {
+        return hashShard(id, int(shards.size()));
+    }
+
+    QString key = region.trimmed().toString();
+    auto it = regionShards.constFind(key);
+    return it != regionShards.constEnd() ? it.value() : addShard(key);
+}
+
+int ProverbCollection::ownerOf(quint64 id) const
+{
+    if (sharding == ByHash) {
+        return hashShard(id, int(shards.size()));
+    }
+    return owners.value(id, -1);
+}
+
+ProverbJournal::RowFilter ProverbCollection::rowsOf(int shard) const
+{
+    if (sharding == ByHash) {
+        int count = int(shards.size());
+        return [shard, count](const ProverbColumns &proverbs, int row) {
+            return hashShard(proverbs.id(row), count) == shard;
+        };
+    }
+
+    QString region = shards.at(shard).region;
+    return [region](const ProverbColumns &proverbs, int row) {
+        return proverbs.field(row, ProverbColumns::Region).trimmed() == region;
+    };
+}
@@ -0,0 +1,99 @@
+#ifndef PROVERBCOLLECTION_H
+#define PROVERBCOLLECTION_H
+
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringView>
+
+#include "proverb.h"
+#include "proverbbackend.h"
+#include "proverbcolumns.h"
+#include "proverbjournal.h"
+#include "proverbsnapshot.h"
+#include "shardedhash.h"
+
+// A collection stored as a directory of shards, each a journaled snapshot
+// of its own (see ProverbJournal), listed in a manifest:
+//   <directory>/manifest.json   sharding scheme and shard files, in order
+//   <directory>/<shard>.json    one shard, with its .journal, .bin and so on
+// Records go to a shard by a hash of their id or by their region. Shards
+// load concurrently, each change is journaled only to the shards it
+// touches, and a save rewrites only the shards changed since the last one.
+class ProverbCollection : public ProverbBackend {
+public:
+    enum Sharding {
+        ByHash,
+        ByRegion
+    };
+
+    static const int DefaultHashShards = 16;
+
+    // The scheme is only used to start a new collection; an existing one
+    // keeps the one in its manifest
+    explicit ProverbCollection(const QString &directory, Sharding sharding = ByHash,
+                               int hashShards = DefaultHashShards);
+
+    static bool exists(const QString &directory);
+
+    // Loads every shard on the global thread pool and appends their records
+    // in manifest order. Records found in the wrong shard are moved on the
+    // next save. Returns false when there is no collection yet; the first
+    // write then creates it.
+    bool load(QList<Proverb> &proverbs) override;
+    // ReadOnly loads each shard so (see ProverbJournal::load()) and leaves
+    // misplaced records where they are
+    bool load(QList<Proverb> &proverbs, ProverbJournal::LoadMode mode);
+
+    // The binary snapshots the last load() mapped, one per shard at most
+    MappedSnapshots mappedSnapshots() const override;
+
+    // The highest of the shards' marks
+    quint64 nextId() override;
+
+    bool appendAdd(const Proverb &proverb) override;
+    bool appendEdit(const Proverb &proverb) override;
+    bool appendRemove(quint64 id) override;
+
+    // For changes made without the append calls, like a bulk import: the
+    // shards of every row from firstRow on are rewritten by the next save,
+    // and from row 0 every shard is
+    void markDirty(const ProverbColumns &proverbs, int firstRow = 0) override;
+
+    // Rewrite the shards changed since the last write, each on its own
+    // worker thread for the async one
+    bool writeSnapshot(const ProverbColumns &proverbs) override;
+    QFuture<bool> writeSnapshotAsync(const ProverbColumns &proverbs) override;
+    void waitForWrites();
+
+private:
+    struct Shard {
+        QString file;
+        QString region;     // ByRegion only
+        QSharedPointer<ProverbJournal> journal;
+    };
+
+    static int hashShard(quint64 id, int count);
+
+    void startNew();
+    bool readManifest();
+    bool ensureManifest();
+    int addShard(const QString &region);
+    int shardFor(quint64 id, QStringView region);
+    int ownerOf(quint64 id) const;
+    ProverbJournal::RowFilter rowsOf(int shard) const;
+
+    QString directory;
+    Sharding sharding;
+    int hashShards;
+    QList<Shard> shards;
+    QHash<QString, int> regionShards;   // ByRegion: trimmed region to shard
+    ShardedHash<quint64, int> owners;   // ByRegion: shard holding each id
+    QSet<int> dirty;
+    bool manifestWritten = false;       // false while it misses a shard
+};
+
+#endif // PROVERBCOLLECTION_H
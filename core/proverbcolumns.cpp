@@ -0,0 +1,323 @@
+#include "proverbcolumns.h"
+
+namespace {
+const QString *fieldOf(const Proverb &proverb, ProverbColumns::Field field)
+{
+    switch (field) {
+    case ProverbColumns::ProverbText: return &proverb.proverb;
+    case ProverbColumns::Transliteration: return &proverb.transliteration;
+    case ProverbColumns::Meaning: return &proverb.meaning;
+    case ProverbColumns::EnglishEquivalent: return &proverb.englishEquivalent;
+    case ProverbColumns::Region: return &proverb.region;
+    case ProverbColumns::UsageContext: return &proverb.usageContext;
+    default: return nullptr;
+    }
+}
+}
+
+ProverbColumns ProverbColumns::fromList(const QList<Proverb> &proverbs,
+                                        const MappedSnapshots &details)
+{
+    ProverbColumns columns;
+    for (const QSharedPointer<const ProverbSnapshot> &snapshot : details) {
+        if (snapshot) {
+            columns.details.append(snapshot);
+        }
+    }
+    columns.reserve(proverbs.size());
+    for (const Proverb &p : proverbs) {
+        columns.append(p);
+    }
+    return columns;
+}
+
+int ProverbColumns::size() const
+{
+    return rowSlots.size();
+}
+
+void ProverbColumns::reserve(int rows)
+{
+    ids.reserve(rows);
+    for (ArenaColumn<char16_t> &column : fields) {
+        column.reserve(rows);
+    }
+    if (!details.isEmpty()) {
+        for (int f = ProverbText + 1; f < FieldCount; ++f) {
+            mapped[f].reserve(rows);
+        }
+    }
+    tagColumn.reserve(rows);
+}
+
+void ProverbColumns::clear()
+{
+    rowSlots.clear();
+    ids.clear();
+    for (ArenaColumn<char16_t> &column : fields) {
+        column.clear();
+    }
+    tagColumn.clear();
+    tagDictionary.clear();
+    details.clear();
+    lastSource = 0;
+    for (ChunkedVector<MappedRef> &refs : mapped) {
+        refs.clear();
+    }
+}
+
+void ProverbColumns::append(const Proverb &proverb)
+{
+    int slot = rowSlots.append();
+    ids.append(proverb.id);
+    setFields(slot, proverb, true);
+    setTags(slot, proverb.tags, true);
+}
+
+void ProverbColumns::update(int row, const Proverb &proverb)
+{
+    if (row < 0 || row >= size()) {
+        return;
+    }
+
+    // Intern first so tags shared by the old and new version never hit zero
+    int slot = rowSlots.slotOf(row);
+    const int *oldTags = tagColumn.data(slot);
+    QVector<int> old(oldTags, oldTags + tagColumn.length(slot));
+    ids[slot] = proverb.id;
+    setFields(slot, proverb, false);
+    setTags(slot, proverb.tags, false);
+    for (int id : old) {
+        tagDictionary.release(id);
+    }
+}
+
+void ProverbColumns::remove(int row)
+{
+    if (row < 0 || row >= size()) {
+        return;
+    }
+
+    // The slot is emptied in place; every later record keeps its own
+    int slot = rowSlots.remove(row);
+    releaseTags(slot);
+    ids[slot] = 0;
+    for (ArenaColumn<char16_t> &column : fields) {
+        column.set(slot, nullptr, 0);
+    }
+    for (ChunkedVector<MappedRef> &refs : mapped) {
+        if (!refs.isEmpty()) {
+            refs[slot] = MappedRef{NotMapped, 0, 0};
+        }
+    }
+    tagColumn.set(slot, nullptr, 0);
+
+    if (rowSlots.wantsCompaction()) {
+        compact();
+    }
+}
+
+quint64 ProverbColumns::id(int row) const
+{
+    return ids[rowSlots.slotOf(row)];
+}
+
+QStringView ProverbColumns::field(int row, Field field) const
+{
+    int slot = rowSlots.slotOf(row);
+    if (!details.isEmpty() && field != ProverbText) {
+        const MappedRef &ref = mapped[field][slot];
+        if (ref.offset != NotMapped) {
+            return details.at(ref.source)->stringAt(ref.offset, ref.length);
+        }
+    }
+    return QStringView(fields[field].data(slot), fields[field].length(slot));
+}
+
+const int *ProverbColumns::tagIds(int row) const
+{
+    return tagColumn.data(rowSlots.slotOf(row));
+}
+
+int ProverbColumns::tagCount(int row) const
+{
+    return tagColumn.length(rowSlots.slotOf(row));
+}
+
+const TermDictionary &ProverbColumns::tagTerms() const
+{
+    return tagDictionary;
+}
+
+QStringList ProverbColumns::tags(int row) const
+{
+    QStringList result;
+    int slot = rowSlots.slotOf(row);
+    const int *tagIds = tagColumn.data(slot);
+    int count = tagColumn.length(slot);
+
+    result.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        result.append(tagDictionary.term(tagIds[i]));
+    }
+    return result;
+}
+
+ProverbRef ProverbColumns::ref(int row) const
+{
+    return ProverbRef(this, row);
+}
+
+Proverb ProverbColumns::proverb(int row) const
+{
+    Proverb p;
+    p.id = id(row);
+    p.proverb = field(row, ProverbText).toString();
+    p.transliteration = field(row, Transliteration).toString();
+    p.meaning = field(row, Meaning).toString();
+    p.englishEquivalent = field(row, EnglishEquivalent).toString();
+    p.tags = tags(row);
+    p.region = field(row, Region).toString();
+    p.usageContext = field(row, UsageContext).toString();
+    return p;
+}
+
+void ProverbColumns::setFields(int slot, const Proverb &proverb, bool append)
+{
+    for (int f = 0; f < FieldCount; ++f) {
+        QStringView text(*fieldOf(proverb, Field(f)));
+        bool lazy = !details.isEmpty() && f != ProverbText;
+
+        // A field still viewing a snapshot is referenced, not copied
+        MappedRef ref = lazy ? mappedRef(text) : MappedRef{NotMapped, 0, 0};
+        if (ref.offset != NotMapped) {
+            text = QStringView();
+        }
+
+        if (append) {
+            fields[f].append(text.utf16(), int(text.size()));
+        } else {
+            fields[f].set(slot, text.utf16(), int(text.size()));
+        }
+
+        if (lazy && append) {
+            mapped[f].append(ref);
+        } else if (lazy) {
+            mapped[f][slot] = ref;
+        }
+    }
+}
+
+void ProverbColumns::setTags(int slot, const QStringList &tags, bool append)
+{
+    QVector<int> tagIds;
+    tagIds.reserve(tags.size());
+    for (const QString &tag : tags) {
+        tagIds.append(tagDictionary.intern(tag));
+    }
+
+    if (append) {
+        tagColumn.append(tagIds.constData(), tagIds.size());
+    } else {
+        tagColumn.set(slot, tagIds.constData(), tagIds.size());
+    }
+}
+
+void ProverbColumns::releaseTags(int slot)
+{
+    const int *tagIds = tagColumn.data(slot);
+    for (int i = 0; i < tagColumn.length(slot); ++i) {
+        tagDictionary.release(tagIds[i]);
+    }
+}
+
+ProverbColumns::MappedRef ProverbColumns::mappedRef(QStringView text)
+{
+    // Records arrive grouped by snapshot, so the last one found usually
+    // holds this field too
+    for (int i = 0; i < details.size(); ++i) {
+        int source = (lastSource + i) % int(details.size());
+        qint64 offset = details.at(source)->offsetOf(text);
+        if (offset >= 0) {
+            lastSource = source;
+            return {quint32(offset), quint32(text.size()), quint16(source)};
+        }
+    }
+    return {NotMapped, 0, 0};
+}
+
+void ProverbColumns::compact()
+{
+    const QVector<int> renumbered = rowSlots.compact();
+    ids = RowSlots::keepLive(ids, renumbered);
+    for (ArenaColumn<char16_t> &column : fields) {
+        column.keepLive(renumbered);
+    }
+    for (ChunkedVector<MappedRef> &refs : mapped) {
+        if (!refs.isEmpty()) {
+            refs = RowSlots::keepLive(refs, renumbered);
+        }
+    }
+    tagColumn.keepLive(renumbered);
+}
+
+ProverbRef::ProverbRef(const ProverbColumns *columns, int row)
+    : columns(columns),
+    index(row)
+{
+}
+
+bool ProverbRef::isNull() const
+{
+    return !columns || index < 0 || index >= columns->size();
+}
+
+int ProverbRef::row() const
+{
+    return index;
+}
+
+quint64 ProverbRef::id() const
+{
+    return isNull() ? 0 : columns->id(index);
+}
+
+QStringView ProverbRef::proverb() const
+{
+    return isNull() ? QStringView() : columns->field(index, ProverbColumns::ProverbText);
+}
+
+QStringView ProverbRef::transliteration() const
+{
+    return isNull() ? QStringView() : columns->field(index, ProverbColumns::Transliteration);
+}
+
+QStringView ProverbRef::meaning() const
+{
+    return isNull() ? QStringView() : columns->field(index, ProverbColumns::Meaning);
+}
+
+QStringView ProverbRef::englishEquivalent() const
+{
+    return isNull() ? QStringView() : columns->field(index, ProverbColumns::EnglishEquivalent);
+}
+
+QStringView ProverbRef::region() const
+{
+    return isNull() ? QStringView() : columns->field(index, ProverbColumns::Region);
+}
+
+QStringView ProverbRef::usageContext() const
+{
+    return isNull() ? QStringView() : columns->field(index, ProverbColumns::UsageContext);
+}
+
+QStringList ProverbRef::tags() const
+{
+    return isNull() ? QStringList() : columns->tags(index);
+}
+
+Proverb ProverbRef::toProverb() const
+{
+    return isNull() ? Proverb() : columns->proverb(index);
+}
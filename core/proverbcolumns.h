@@ -0,0 +1,129 @@
+#ifndef PROVERBCOLUMNS_H
+#define PROVERBCOLUMNS_H
+
+#include <QList>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+
+#include "arenacolumn.h"
+#include "chunkedvector.h"
+#include "proverb.h"
+#include "proverbsnapshot.h"
+#include "rowslots.h"
+#include "termdictionary.h"
+
+class ProverbRef;
+
+// Struct-of-arrays storage for the collection: one UTF-16 arena per text
+// field, an id column and a column of interned tag ids. A record costs a
+// few array slots rather than eight heap strings, and a scan over one
+// field touches only that field's arena. Every column is chunked, so a
+// copy shares all of it and an edit made while a copy is held clones a
+// chunk or two instead of the collection.
+//
+// Columns built over mapped snapshots are lazy: only the list text is
+// copied in, and every other field of a record still unchanged from its
+// snapshot stays a (snapshot, offset, length) reference that is read on
+// demand. The mapping's pages are the detail cache: reading a field needs
+// no decoding, and the OS keeps recently read pages resident and drops
+// cold ones, so no LRU of copies is kept. Records added or edited since
+// the snapshot, and loads without a mapping (a ReadOnly load of JSON
+// without a current cache), hold every field in the arenas.
+//
+// Values are stored by RowSlots slot, so a remove empties the record's own
+// entries rather than shifting every later chunk; rows are translated to
+// slots on access.
+class ProverbColumns {
+public:
+    enum Field {
+        ProverbText,
+        Transliteration,
+        Meaning,
+        EnglishEquivalent,
+        Region,
+        UsageContext,
+        FieldCount
+    };
+
+    // Fields of proverbs that are views into one of details are referenced
+    // rather than copied
+    static ProverbColumns fromList(const QList<Proverb> &proverbs,
+                                   const MappedSnapshots &details = MappedSnapshots());
+
+    int size() const;
+    void reserve(int rows);
+    void clear();
+
+    void append(const Proverb &proverb);
+    void update(int row, const Proverb &proverb);
+    void remove(int row);
+
+    quint64 id(int row) const;
+    QStringView field(int row, Field field) const;
+
+    // Ids into tagTerms() of the row's tags, in their original order
+    const int *tagIds(int row) const;
+    int tagCount(int row) const;
+    const TermDictionary &tagTerms() const;
+    QStringList tags(int row) const;
+
+    ProverbRef ref(int row) const;
+    Proverb proverb(int row) const;
+
+private:
+    // Offset into a details string table, or NotMapped for the arena
+    struct MappedRef {
+        quint32 offset;
+        quint32 length;
+        quint16 source;     // index into details
+    };
+    static const quint32 NotMapped = 0xffffffffu;
+
+    void setFields(int slot, const Proverb &proverb, bool append);
+    void setTags(int slot, const QStringList &tags, bool append);
+    void releaseTags(int slot);
+    MappedRef mappedRef(QStringView text);
+    void compact();
+
+    RowSlots rowSlots;
+    ChunkedVector<quint64> ids;
+    ArenaColumn<char16_t> fields[FieldCount];
+    ArenaColumn<int> tagColumn;
+    TermDictionary tagDictionary;
+    // Only filled for fields after ProverbText, and only when lazy
+    MappedSnapshots details;
+    int lastSource = 0;         // where the previous mapped field was found
+    ChunkedVector<MappedRef> mapped[FieldCount];
+};
+
+// Read-only view of one stored record. Fields are views into the arenas
+// or the mapped snapshot, so a ref is only valid until the columns are
+// next modified.
+class ProverbRef {
+public:
+    ProverbRef() = default;
+    ProverbRef(const ProverbColumns *columns, int row);
+
+    bool isNull() const;
+    int row() const;
+
+    quint64 id() const;
+    QStringView proverb() const;
+    QStringView transliteration() const;
+    QStringView meaning() const;
+    QStringView englishEquivalent() const;
+    QStringView region() const;
+    QStringView usageContext() const;
+    QStringList tags() const;
+
+    // Copies the record out, e.g. for editing or serialization
+    Proverb toProverb() const;
+
+private:
+    const ProverbColumns *columns = nullptr;
+    int index = -1;
+};
+
+#endif // PROVERBCOLUMNS_H
@@ -0,0 +1,647 @@
+#include "proverbdatabase.h"
+
+#include <QAtomicInt>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSharedPointer>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QThreadStorage>
+#include <QVariant>
+#include <QtConcurrent>
+
+#include "proverbids.h"
+#include "proverbindex.h"
+
+namespace {
+const char *const Driver = "QSQLITE";
+
+// Run on every connection
+const char *const Setup[] = {
+    "PRAGMA journal_mode = WAL",
+    "PRAGMA synchronous = FULL",
+};
+
+const char *const Schema[] = {
+    "CREATE TABLE IF NOT EXISTS proverbs ("
+    " id INTEGER PRIMARY KEY,"
+    " proverb TEXT NOT NULL,"
+    " transliteration TEXT NOT NULL,"
+    " meaning TEXT NOT NULL,"
+    " english_equivalent TEXT NOT NULL,"
+    " region TEXT NOT NULL,"
+    " usage_context TEXT NOT NULL)",
+    "CREATE INDEX IF NOT EXISTS proverbs_region ON proverbs (region)",
+    "CREATE TABLE IF NOT EXISTS proverb_tags ("
+    " proverb_id INTEGER NOT NULL,"
+    " position INTEGER NOT NULL,"
+    " tag TEXT NOT NULL,"
+    " PRIMARY KEY (proverb_id, position)) WITHOUT ROWID",
+    "CREATE INDEX IF NOT EXISTS proverb_tags_tag ON proverb_tags (tag, proverb_id)",
+    "CREATE VIRTUAL TABLE IF NOT EXISTS proverb_search USING fts5 (search_key, tokenize = 'trigram')",
+    // One row: the largest id ever removed, so nextId() never reuses it
+    "CREATE TABLE IF NOT EXISTS removed_ids (slot INTEGER PRIMARY KEY, high INTEGER NOT NULL)",
+};
+
+// Raise the removed_ids mark to an id, or to the largest one about to be cleared
+const char *const RaiseRemoved = "INSERT INTO removed_ids (slot, high) VALUES (0, ?)"
+                                 " ON CONFLICT (slot) DO UPDATE SET high = MAX(high, excluded.high)";
+const char *const RaiseRemovedToAll = "INSERT INTO removed_ids (slot, high)"
+                                      " SELECT 0, COALESCE(MAX(id), 0) FROM proverbs WHERE true"
+                                      " ON CONFLICT (slot) DO UPDATE SET high = MAX(high, excluded.high)";
+
+// In the order readRecord() expects
+const QString RecordColumns = "proverbs.id, proverbs.proverb, proverbs.transliteration,"
+                              " proverbs.meaning, proverbs.english_equivalent,"
+                              " proverbs.region, proverbs.usage_context";
+
+// Background writes each open a connection under a fresh name
+QAtomicInt writerConnections;
+
+// forThisThread()'s objects, closed as their thread ends
+QThreadStorage<QHash<QString, QSharedPointer<ProverbDatabase>>> threadDatabases;
+
+// An FTS5 string; with the trigram tokenizer it matches anywhere in a key
+QString phrase(QString text)
+{
+    return '"' + text.replace('"', "\"\"") + '"';
+}
+
+// LIKE pattern for text anywhere, with its own wildcards taken literally
+QString containsPattern(QString text)
+{
+    text.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+    return '%' + text + '%';
+}
+}
+
+// The prepared insert and delete statements of one connection
+class ProverbDatabase::Writer {
+public:
+    explicit Writer(const QSqlDatabase &database)
+        : insertRecord(database),
+        insertTag(database),
+        insertKey(database),
+        deleteRecord(database),
+        deleteTags(database),
+        deleteKey(database),
+        raiseRemoved(database)
+    {
+    }
+
+    bool prepare()
+    {
+        return prepare(insertRecord, "INSERT INTO proverbs (id, proverb, transliteration, meaning,"
+                                     " english_equivalent, region, usage_context)"
+                                     " VALUES (?, ?, ?, ?, ?, ?, ?)") &&
+               prepare(insertTag, "INSERT INTO proverb_tags (proverb_id, position, tag) VALUES (?, ?, ?)") &&
+               prepare(insertKey, "INSERT INTO proverb_search (rowid, search_key) VALUES (?, ?)") &&
+               prepare(deleteRecord, "DELETE FROM proverbs WHERE id = ?") &&
+               prepare(deleteTags, "DELETE FROM proverb_tags WHERE proverb_id = ?") &&
+               prepare(deleteKey, "DELETE FROM proverb_search WHERE rowid = ?") &&
+               prepare(raiseRemoved, RaiseRemoved);
+    }
+
+    // Replaces the record with the same id unless known to be new
+    bool write(const Proverb &proverb, bool replace = true)
+    {
+        if (replace && !remove(proverb.id)) {
+            return false;
+        }
+
+        qint64 id = qint64(proverb.id);
+        if (!run(insertRecord, {id, proverb.proverb, proverb.transliteration, proverb.meaning,
+                                proverb.englishEquivalent, proverb.region, proverb.usageContext})) {
+            return false;
+        }
+        for (int i = 0; i < proverb.tags.size(); ++i) {
+            if (!run(insertTag, {id, i, proverb.tags.at(i)})) {
+                return false;
+            }
+        }
+        return run(insertKey, {id, ProverbIndex::searchKey(proverb)});
+    }
+
+    bool remove(quint64 id)
+    {
+        return run(deleteRecord, {qint64(id)}) && run(deleteTags, {qint64(id)}) &&
+               run(deleteKey, {qint64(id)}) && run(raiseRemoved, {qint64(id)});
+    }
+
+    QString error;
+
+private:
+    bool prepare(QSqlQuery &statement, const char *sql)
+    {
+        if (statement.prepare(sql)) {
+            return true;
+        }
+        error = statement.lastError().text();
+        return false;
+    }
+
+    bool run(QSqlQuery &statement, const QVariantList &values)
+    {
+        for (int i = 0; i < values.size(); ++i) {
+            statement.bindValue(i, values.at(i));
+        }
+        if (statement.exec()) {
+            return true;
+        }
+        error = statement.lastError().text();
+        return false;
+    }
+
+    QSqlQuery insertRecord;
+    QSqlQuery insertTag;
+    QSqlQuery insertKey;
+    QSqlQuery deleteRecord;
+    QSqlQuery deleteTags;
+    QSqlQuery deleteKey;
+    QSqlQuery raiseRemoved;
+};
+
+ProverbDatabase::ProverbDatabase(const QString &path)
+    : path(path),
+    connectionName(QString("fakra-%1").arg(quintptr(this), 0, 16))
+{
+    if (!openConnection(connectionName, path, &lastError)) {
+        return;
+    }
+
+    QSqlDatabase database = QSqlDatabase::database(connectionName);
+    QSqlQuery query(database);
+    for (const char *statement : Schema) {
+        if (!query.exec(statement)) {
+            lastError = query.lastError().text();
+            return;
+        }
+    }
+
+    writer.reset(new Writer(database));
+    if (!writer->prepare()) {
+        lastError = writer->error;
+        writer.reset();
+    }
+}
+
+ProverbDatabase::~ProverbDatabase()
+{
+    writing.waitForFinished();
+
+    // Every statement has to be gone before its connection is
+    writer.reset();
+    statements.clear();
+    QSqlDatabase::database(connectionName, false).close();
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+bool ProverbDatabase::isDatabasePath(const QString &path)
+{
+    QString suffix = QFileInfo(path).suffix().toLower();
+    return suffix == "sqlite" || suffix == "db";
+}
+
+ProverbDatabase *ProverbDatabase::forThisThread(const QString &path)
+{
+    QSharedPointer<ProverbDatabase> &database = threadDatabases.localData()[path];
+    if (!database) {
+        database.reset(new ProverbDatabase(path));
+    }
+    return database.data();
+}
+
+bool ProverbDatabase::isOpen() const
+{
+    return !writer.isNull();
+}
+
+QString ProverbDatabase::errorString() const
+{
+    return lastError;
+}
+
+bool ProverbDatabase::load(QList<Proverb> &proverbs)
+{
+    int first = int(proverbs.size());
+    return forEachRecord([&proverbs](Proverb &proverb) {
+        proverbs.append(std::move(proverb));
+    }) && proverbs.size() > first;
+}
+
+bool ProverbDatabase::isEmpty()
+{
+    return strings("SELECT id FROM proverbs LIMIT 1").isEmpty();
+}
+
+bool ProverbDatabase::appendAdd(const Proverb &proverb)
+{
+    return inTransaction([this, &proverb]() {
+        return writer->write(proverb);
+    });
+}
+
+bool ProverbDatabase::appendEdit(const Proverb &proverb)
+{
+    return inTransaction([this, &proverb]() {
+        return writer->write(proverb);
+    });
+}
+
+bool ProverbDatabase::appendRemove(quint64 id)
+{
+    return inTransaction([this, id]() {
+        return writer->remove(id);
+    });
+}
+
+bool ProverbDatabase::appendAll(QList<Proverb> proverbs)
+{
+    quint64 id = nextId();
+    for (Proverb &proverb : proverbs) {
+        proverb.id = id++;
+    }
+
+    return inTransaction([this, &proverbs]() {
+        for (const Proverb &proverb : proverbs) {
+            if (!writer->write(proverb, false)) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+quint64 ProverbDatabase::nextId()
+{
+    if (!isOpen()) {
+        return 1;
+    }
+    writing.waitForFinished();
+
+    // The primary key index has the largest id at its end
+    QSqlQuery &query = prepared("SELECT MAX(COALESCE((SELECT MAX(id) FROM proverbs), 0),"
+                                " COALESCE((SELECT high FROM removed_ids), 0)) + 1");
+    if (!query.exec() || !query.next()) {
+        fail(query.lastError().text());
+        return 1;
+    }
+    quint64 id = query.value(0).toULongLong();
+    query.finish();
+    return id;
+}
+
+void ProverbDatabase::markDirty(const ProverbColumns &proverbs, int firstRow)
+{
+    Q_UNUSED(proverbs);
+    firstRow = qMax(0, firstRow);
+    dirtyFrom = dirtyFrom < 0 ? firstRow : qMin(dirtyFrom, firstRow);
+}
+
+bool ProverbDatabase::writeSnapshot(const ProverbColumns &proverbs)
+{
+    writing.waitForFinished();
+    if (dirtyFrom < 0 || !isOpen()) {
+        return isOpen();
+    }
+
+    int first = dirtyFrom;
+    dirtyFrom = -1;
+    return writeRecords(connectionName, first == 0, proverbs.size() - first,
+                        [&proverbs, first](int i) { return proverbs.proverb(first + i); }, &lastError);
+}
+
+QFuture<bool> ProverbDatabase::writeSnapshotAsync(const ProverbColumns &proverbs)
+{
+    writing.waitForFinished();
+    if (dirtyFrom < 0 || !isOpen()) {
+        bool ok = isOpen();
+        return QtConcurrent::run([ok]() { return ok; });
+    }
+
+    // The column copy is implicitly shared, so the worker sees this exact state
+    QString file = path;
+    ProverbColumns snapshot = proverbs;
+    int first = dirtyFrom;
+    dirtyFrom = -1;
+    writing = QtConcurrent::run([file, snapshot, first]() {
+        QString name = QString("fakra-writer-%1").arg(writerConnections.fetchAndAddRelaxed(1));
+        QString error;
+        bool ok = openConnection(name, file, &error) &&
+                  writeRecords(name, first == 0, snapshot.size() - first,
+                               [&snapshot, first](int i) { return snapshot.proverb(first + i); }, &error);
+        QSqlDatabase::database(name, false).close();
+        QSqlDatabase::removeDatabase(name);
+        return ok;
+    });
+    return writing;
+}
+
+ProverbDatabase::Page ProverbDatabase::query(const ProverbFilter &filter, int offset, int limit)
+{
+    Page page;
+    if (!isOpen()) {
+        return page;
+    }
+
+    QString from = "FROM proverbs";
+    QStringList conditions;
+    QVariantList values;
+    bool ranked = false;
+    if (!filter.searchText.isEmpty()) {
+        from += " JOIN proverb_search ON proverb_search.rowid = proverbs.id";
+        // The trigram index answers MATCH; anything shorter is a scan
+        if (filter.searchText.size() >= ProverbIndex::GramSize) {
+            conditions.append("proverb_search MATCH ?");
+            values.append(phrase(filter.searchText));
+            ranked = filter.ranked;
+        } else {
+            conditions.append("proverb_search.search_key LIKE ? ESCAPE '\\'");
+            values.append(containsPattern(filter.searchText));
+        }
+    }
+    if (!filter.tag.isEmpty()) {
+        conditions.append("EXISTS (SELECT 1 FROM proverb_tags WHERE proverb_tags.tag = ?"
+                          " AND proverb_tags.proverb_id = proverbs.id)");
+        values.append(filter.tag);
+    }
+    if (!filter.region.isEmpty()) {
+        conditions.append("proverbs.region = ?");
+        values.append(filter.region);
+    }
+    QString where = conditions.isEmpty() ? QString() : " WHERE " + conditions.join(" AND ");
+
+    auto run = [this, &values](QSqlQuery &statement, const QVariantList &extra) {
+        const QVariantList bound = values + extra;
+        for (int i = 0; i < bound.size(); ++i) {
+            statement.bindValue(i, bound.at(i));
+        }
+        return statement.exec() || fail(statement.lastError().text());
+    };
+
+    QSqlQuery &count = prepared("SELECT COUNT(*) " + from + where);
+    if (!run(count, {}) || !count.next()) {
+        return page;
+    }
+    page.total = count.value(0).toInt();
+    count.finish();
+
+    QString order = ranked ? "bm25(proverb_search), proverbs.id" : "proverbs.id";
+    QSqlQuery &select = prepared("SELECT " + RecordColumns + ' ' + from + where +
+                                " ORDER BY " + order + " LIMIT ? OFFSET ?");
+    if (!run(select, {limit < 0 ? -1 : limit, qMax(0, offset)})) {
+        return page;
+    }
+    while (select.next()) {
+        page.proverbs.append(readRecord(select));
+    }
+    select.finish();
+
+    QSqlQuery &tags = prepared("SELECT tag FROM proverb_tags WHERE proverb_id = ? ORDER BY position");
+    for (Proverb &proverb : page.proverbs) {
+        tags.bindValue(0, qint64(proverb.id));
+        if (!tags.exec()) {
+            fail(tags.lastError().text());
+            break;
+        }
+        while (tags.next()) {
+            proverb.tags.append(tags.value(0).toString());
+        }
+    }
+    tags.finish();
+    return page;
+}
+
+QStringList ProverbDatabase::tags()
+{
+    return strings("SELECT DISTINCT tag FROM proverb_tags ORDER BY tag");
+}
+
+QStringList ProverbDatabase::regions()
+{
+    return strings("SELECT DISTINCT region FROM proverbs ORDER BY region");
+}
+
+bool ProverbDatabase::exportJson(const QString &path)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return fail(file.errorString());
+    }
+
+    // One record at a time, so memory stays flat however large the collection
+    bool first = true;
+    file.write("[\n");
+    bool read = forEachRecord([&file, &first](Proverb &proverb) {
+        file.write(first ? "    " : ",\n    ");
+        file.write(QJsonDocument(proverb.toJson()).toJson(QJsonDocument::Compact));
+        first = false;
+    });
+    file.write("\n]\n");
+
+    if (!read) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit() || fail(file.errorString());
+}
+
+bool ProverbDatabase::importJson(const QString &path)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(file.errorString());
+    }
+    QJsonParseError error;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        return fail(error.errorString());
+    }
+    if (!document.isArray()) {
+        return fail("expected a JSON array of proverbs");
+    }
+
+    QList<Proverb> proverbs;
+    const QJsonArray records = document.array();
+    proverbs.reserve(records.size());
+    for (const QJsonValue &value : records) {
+        proverbs.append(Proverb::fromJson(value.toObject()));
+    }
+    ProverbIdIndex::assignMissing(proverbs);
+
+    writing.waitForFinished();
+    dirtyFrom = -1;
+    return writeRecords(connectionName, true, int(proverbs.size()),
+                        [&proverbs](int i) { return proverbs.at(i); }, &lastError);
+}
+
+bool ProverbDatabase::openConnection(const QString &name, const QString &path, QString *error)
+{
+    QSqlDatabase database = QSqlDatabase::addDatabase(Driver, name);
+    database.setDatabaseName(path);
+    // Waits out another connection's write instead of failing at once
+    database.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+    if (!database.open()) {
+        *error = database.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(database);
+    for (const char *statement : Setup) {
+        if (!query.exec(statement)) {
+            *error = query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ProverbDatabase::writeRecords(const QString &connection, bool replaceAll, int count,
+                                   const RecordAt &recordAt, QString *error)
+{
+    QSqlDatabase database = QSqlDatabase::database(connection);
+    Writer records(database);
+    if (!records.prepare()) {
+        *error = records.error;
+        return false;
+    }
+    if (!database.transaction()) {
+        *error = database.lastError().text();
+        return false;
+    }
+
+    // A single transaction, so readers see all of the write or none of it
+    bool ok = true;
+    if (replaceAll) {
+        QSqlQuery clear(database);
+        // Ids cleared here may not come back either
+        ok = clear.exec(RaiseRemovedToAll) && clear.exec("DELETE FROM proverbs") && clear.exec("DELETE FROM proverb_tags") &&
+             clear.exec("DELETE FROM proverb_search");
+        if (!ok) {
+            records.error = clear.lastError().text();
+        }
+    }
+    for (int i = 0; ok && i < count; ++i) {
+        ok = records.write(recordAt(i), !replaceAll);
+    }
+
+    if (ok && database.commit()) {
+        return true;
+    }
+    *error = ok ? database.lastError().text() : records.error;
+    database.rollback();
+    return false;
+}
+
+Proverb ProverbDatabase::readRecord(const QSqlQuery &query)
+{
+    Proverb proverb;
+    proverb.id = query.value(0).toULongLong();
+    proverb.proverb = query.value(1).toString();
+    proverb.transliteration = query.value(2).toString();
+    proverb.meaning = query.value(3).toString();
+    proverb.englishEquivalent = query.value(4).toString();
+    proverb.region = query.value(5).toString();
+    proverb.usageContext = query.value(6).toString();
+    return proverb;
+}
+
+bool ProverbDatabase::forEachRecord(const std::function<void(Proverb &)> &f)
+{
+    if (!isOpen()) {
+        return false;
+    }
+    writing.waitForFinished();
+
+    QSqlQuery &records = prepared("SELECT " + RecordColumns + " FROM proverbs ORDER BY id");
+    QSqlQuery &tags = prepared("SELECT proverb_id, tag FROM proverb_tags ORDER BY proverb_id, position");
+    if (!records.exec()) {
+        return fail(records.lastError().text());
+    }
+    if (!tags.exec()) {
+        return fail(tags.lastError().text());
+    }
+
+    // Both come in id order, so the tags are merged in as the records stream past
+    bool moreTags = tags.next();
+    while (records.next()) {
+        Proverb proverb = readRecord(records);
+        while (moreTags && tags.value(0).toULongLong() < proverb.id) {
+            moreTags = tags.next();
+        }
+        while (moreTags && tags.value(0).toULongLong() == proverb.id) {
+            proverb.tags.append(tags.value(1).toString());
+            moreTags = tags.next();
+        }
+        f(proverb);
+    }
+
+    records.finish();
+    tags.finish();
+    return true;
+}
+
+bool ProverbDatabase::inTransaction(const std::function<bool()> &work)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    // A background write holds the write lock for all of its transaction
+    writing.waitForFinished();
+
+    QSqlDatabase database = QSqlDatabase::database(connectionName);
+    if (!database.transaction()) {
+        return fail(database.lastError().text());
+    }
+    if (!work()) {
+        database.rollback();
+        return fail(writer->error);
+    }
+    return database.commit() || fail(database.lastError().text());
+}
+
+QStringList ProverbDatabase::strings(const QString &sql)
+{
+    QStringList result;
+    if (!isOpen()) {
+        return result;
+    }
+
+    QSqlQuery &query = prepared(sql);
+    if (!query.exec()) {
+        fail(query.lastError().text());
+        return result;
+    }
+    while (query.next()) {
+        result.append(query.value(0).toString());
+    }
+    query.finish();
+    return result;
+}
+
+QSqlQuery &ProverbDatabase::prepared(const QString &sql)
+{
+    std::unique_ptr<QSqlQuery> &statement = statements[sql];
+    if (!statement) {
+        statement.reset(new QSqlQuery(QSqlDatabase::database(connectionName)));
+        statement->setForwardOnly(true);
+        statement->prepare(sql);
+    }
+    return *statement;
+}
+
+bool ProverbDatabase::fail(const QString &message)
+{
+    lastError = message;
+    return false;
+}
@@ -0,0 +1,118 @@
+#ifndef PROVERBDATABASE_H
+#define PROVERBDATABASE_H
+
+#include <QFuture>
+#include <QList>
+#include <QScopedPointer>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include "proverb.h"
+#include "proverbbackend.h"
+#include "proverbcolumns.h"
+#include "proverbfilter.h"
+
+// The collection in an embedded SQLite database, for corpora too large to
+// hold in memory: query() runs a search in SQL and returns one page of it.
+//   proverbs         one row per record, keyed by id, indexed by region
+//   proverb_tags     (proverb_id, position, tag), indexed by tag
+//   proverb_search   FTS5 table over ProverbIndex::searchKey(), with the
+//                    trigram tokenizer so MATCH finds substrings just as
+//                    the in-memory index does
+// In WAL mode searches read while a write goes on. Statements are prepared
+// once per connection, and a connection is only used by the thread that
+// opened it: the object's own by the thread that created the object,
+// each background write opens its own, and forThisThread() gives every
+// other thread, e.g. a search worker, one of its own.
+class ProverbDatabase : public ProverbBackend {
+public:
+    struct Page {
+        int total = 0;              // matches before paging
+        QList<Proverb> proverbs;
+    };
+
+    // Opens the database at path, creating it if needed
+    explicit ProverbDatabase(const QString &path);
+    ~ProverbDatabase() override;
+
+    // Paths ending in .sqlite or .db
+    static bool isDatabasePath(const QString &path);
+
+    // The calling thread's own object over path, opened on first use and
+    // kept, with its prepared statements, until the thread ends. Lets pool
+    // workers query while the owning thread writes.
+    static ProverbDatabase *forThisThread(const QString &path);
+
+    bool isOpen() const;
+    QString errorString() const;
+
+    // Returns false for an empty database as for a missing collection
+    bool load(QList<Proverb> &proverbs) override;
+    // Without reading or counting the records
+    bool isEmpty();
+
+    // Each is one transaction, committed before it returns
+    bool appendAdd(const Proverb &proverb) override;
+    bool appendEdit(const Proverb &proverb) override;
+    bool appendRemove(quint64 id) override;
+
+    // Adds the proverbs as new records numbered from nextId(), in one
+    // transaction
+    bool appendAll(QList<Proverb> proverbs);
+    // After the largest id stored or ever removed
+    quint64 nextId() override;
+
+    void markDirty(const ProverbColumns &proverbs, int firstRow = 0) override;
+    bool writeSnapshot(const ProverbColumns &proverbs) override;
+    QFuture<bool> writeSnapshotAsync(const ProverbColumns &proverbs) override;
+
+    // Matches offset to offset + limit, limit < 0 for all of them. Text,
+    // tag and region are all matched through indexes; ranked results come
+    // in bm25() order, the rest in id order. Unlike ProverbStore::query()
+    // there is no phonetic matching.
+    Page query(const ProverbFilter &filter, int offset, int limit);
+
+    // Every distinct tag and region, sorted, read from their indexes
+    QStringList tags();
+    QStringList regions();
+
+    // The collection as a JSON array of records, the snapshot format, and
+    // back. Export streams the records; import replaces all of them.
+    bool exportJson(const QString &path);
+    bool importJson(const QString &path);
+
+private:
+    class Writer;
+
+    typedef std::function<Proverb(int)> RecordAt;
+
+    static bool openConnection(const QString &name, const QString &path, QString *error);
+    static bool writeRecords(const QString &connection, bool replaceAll, int count,
+                             const RecordAt &recordAt, QString *error);
+    static Proverb readRecord(const QSqlQuery &query);
+
+    // Every record with its tags, in id order
+    bool forEachRecord(const std::function<void(Proverb &)> &f);
+    bool inTransaction(const std::function<bool()> &work);
+    // The first column of every row sql returns
+    QStringList strings(const QString &sql);
+    // The connection's statement for sql, prepared on first use. Each
+    // caller has to be done with it before the next one binds.
+    QSqlQuery &prepared(const QString &sql);
+    bool fail(const QString &message);
+
+    QString path;
+    QString connectionName;
+    QString lastError;
+    QScopedPointer<Writer> writer;
+    std::unordered_map<QString, std::unique_ptr<QSqlQuery>> statements;
+    int dirtyFrom = -1;             // first row to write, -1 when none
+    QFuture<bool> writing;
+};
+
+#endif // PROVERBDATABASE_H
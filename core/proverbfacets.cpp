@@ -0,0 +1,182 @@
+#include "proverbfacets.h"
+
+namespace {
+const RowBitmap EmptyRows;
+
+const RowBitmap &bitmapAt(const QVector<RowBitmap> &bitmaps, int id)
+{
+    return id >= 0 && id < bitmaps.size() ? bitmaps[id] : EmptyRows;
+}
+}
+
+void ProverbFacets::build(const ProverbColumns &records)
+{
+    regionTerms.clear();
+    rowSlots.clear();
+    slotTags.clear();
+    slotRegions.clear();
+    tagBits.clear();
+    regionBits.clear();
+    liveBits = RowBitmap();
+    slotTags.reserve(records.size());
+    slotRegions.reserve(records.size());
+
+    for (int row = 0; row < records.size(); ++row) {
+        appendRow(records, row);
+    }
+}
+
+void ProverbFacets::append(const ProverbColumns &records)
+{
+    appendRow(records, records.size() - 1);
+}
+
+void ProverbFacets::appendRow(const ProverbColumns &records, int row)
+{
+    QVector<int> tagIds;
+    int regionId;
+    read(records, row, tagIds, regionId);
+    int slot = rowSlots.append();
+    slotTags.append(tagIds);
+    slotRegions.append(regionId);
+    liveBits.set(slot);
+    mark(slot, true);
+}
+
+void ProverbFacets::update(int row, const ProverbColumns &records)
+{
+    if (row < 0 || row >= rowSlots.size()) {
+        return;
+    }
+
+    // Read first so a region shared by the old and new version never hits zero
+    int slot = rowSlots.slotOf(row);
+    QVector<int> tagIds;
+    int regionId;
+    read(records, row, tagIds, regionId);
+    regionTerms.release(slotRegions.at(slot));
+    mark(slot, false);
+    slotTags[slot] = tagIds;
+    slotRegions[slot] = regionId;
+    mark(slot, true);
+}
+
+void ProverbFacets::remove(int row)
+{
+    if (row < 0 || row >= rowSlots.size()) {
+        return;
+    }
+
+    // Only the record's own bits change; later records keep their slots
+    int slot = rowSlots.remove(row);
+    regionTerms.release(slotRegions.at(slot));
+    mark(slot, false);
+    liveBits.reset(slot);
+    slotTags[slot] = QVector<int>();
+    slotRegions[slot] = TermDictionary::NoTerm;
+
+    if (rowSlots.wantsCompaction()) {
+        compact();
+    }
+}
+
+bool ProverbFacets::hasTag(int row, int tagId) const
+{
+    return slotTags.at(rowSlots.slotOf(row)).contains(tagId);
+}
+
+int ProverbFacets::regionOf(int row) const
+{
+    return slotRegions.at(rowSlots.slotOf(row));
+}
+
+const RowBitmap &ProverbFacets::tagRows(int tagId) const
+{
+    return bitmapAt(tagBits, tagId);
+}
+
+const RowBitmap &ProverbFacets::regionRows(int regionId) const
+{
+    return bitmapAt(regionBits, regionId);
+}
+
+const RowBitmap &ProverbFacets::liveSlots() const
+{
+    return liveBits;
+}
+
+RowBitmap ProverbFacets::slotsOf(const QVector<int> &sortedRows) const
+{
+    return RowBitmap::fromRows(rowSlots.toSlots(sortedRows));
+}
+
+QVector<int> ProverbFacets::rowsOf(const RowBitmap &slotBits) const
+{
+    return rowSlots.toRows(slotBits.rows());
+}
+
+const TermDictionary &ProverbFacets::regions() const
+{
+    return regionTerms;
+}
+
+void ProverbFacets::read(const ProverbColumns &records, int row, QVector<int> &tagIds, int &regionId)
+{
+    // A tag repeated within one record only needs its bit once
+    const int *ids = records.tagIds(row);
+    for (int i = 0; i < records.tagCount(row); ++i) {
+        if (!tagIds.contains(ids[i])) {
+            tagIds.append(ids[i]);
+        }
+    }
+
+    regionId = TermDictionary::NoTerm;
+    QStringView region = records.field(row, ProverbColumns::Region);
+    if (!region.isEmpty()) {
+        regionId = regionTerms.intern(region.toString());
+    }
+}
+
+void ProverbFacets::mark(int slot, bool set)
+{
+    // Term ids are dense, so the bitmap tables grow with the dictionaries
+    for (int id : slotTags.at(slot)) {
+        if (tagBits.size() <= id) {
+            tagBits.resize(id + 1);
+        }
+    }
+    if (regionBits.size() < regionTerms.idLimit()) {
+        regionBits.resize(regionTerms.idLimit());
+    }
+
+    for (int id : slotTags.at(slot)) {
+        if (set) {
+            tagBits[id].set(slot);
+        } else {
+            tagBits[id].reset(slot);
+        }
+    }
+
+    int regionId = slotRegions.at(slot);
+    if (regionId != TermDictionary::NoTerm) {
+        if (set) {
+            regionBits[regionId].set(slot);
+        } else {
+            regionBits[regionId].reset(slot);
+        }
+    }
+}
+
+void ProverbFacets::compact()
+{
+    // Every bitmap is redrawn from the kept terms once slots equal rows
+    const QVector<int> renumbered = rowSlots.compact();
+    slotTags = RowSlots::keepLive(slotTags, renumbered);
+    slotRegions = RowSlots::keepLive(slotRegions, renumbered);
+    tagBits = QVector<RowBitmap>(tagBits.size());
+    regionBits = QVector<RowBitmap>(regionBits.size());
+    liveBits = RowBitmap::filled(slotTags.size());
+    for (int slot = 0; slot < slotTags.size(); ++slot) {
+        mark(slot, true);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef PROVERBFACETS_H
+#define PROVERBFACETS_H
+
+#include <QVector>
+
+#include "chunkedvector.h"
+#include "proverbcolumns.h"
+#include "rowbitmap.h"
+#include "rowslots.h"
+#include "termdictionary.h"
+
+// Per-row tag and region ids plus one bitmap per term, kept in step with
+// the collection like ProverbIndex. Tag ids are the records' own, from
+// ProverbColumns::tagTerms(), so one dictionary interns every tag; regions
+// are interned here. Filters and facet counts are then
+// bitwise ANDs and popcounts instead of string comparisons. The bitmaps
+// are over RowSlots slots, so a remove clears the record's own bits
+// instead of shifting every bitmap; slotsOf() and rowsOf() translate.
+class ProverbFacets {
+public:
+    // Each reads the record from records once they hold it: append() their
+    // last row, update() the edited one
+    void build(const ProverbColumns &records);
+    void append(const ProverbColumns &records);
+    void update(int row, const ProverbColumns &records);
+    void remove(int row);
+
+    bool hasTag(int row, int tagId) const;
+    int regionOf(int row) const;
+
+    // Slots carrying a term; empty for unknown ids
+    const RowBitmap &tagRows(int tagId) const;
+    const RowBitmap &regionRows(int regionId) const;
+
+    // Every live slot, the slots of sorted rows, and the rows of slots
+    const RowBitmap &liveSlots() const;
+    RowBitmap slotsOf(const QVector<int> &sortedRows) const;
+    QVector<int> rowsOf(const RowBitmap &slotBits) const;
+
+    const TermDictionary &regions() const;
+
+private:
+    void appendRow(const ProverbColumns &records, int row);
+    void read(const ProverbColumns &records, int row, QVector<int> &tagIds, int &regionId);
+    void mark(int slot, bool set);
+    void compact();
+
+    TermDictionary regionTerms;
+    RowSlots rowSlots;
+    ChunkedVector<QVector<int>> slotTags;
+    ChunkedVector<int> slotRegions;
+    QVector<RowBitmap> tagBits;
+    QVector<RowBitmap> regionBits;
+    RowBitmap liveBits;
+};
+
+#endif // PROVERBFACETS_H
@@ -0,0 +1,190 @@
+#include "proverbfilter.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+namespace {
+// How many rows are scanned between cancellation checks
+const int CancelInterval = 1024;
+
+bool cancelled(const ProverbFilter::CancelCheck &isCancelled, int row)
+{
+    return isCancelled && row % CancelInterval == 0 && isCancelled();
+}
+
+// Adds rows spelling the query's words in the other script
+QVector<int> withPhonetic(const ProverbIndex &index, const QString &query, const QVector<int> &rows)
+{
+    const QVector<int> phonetic = index.phoneticMatches(query);
+    if (phonetic.isEmpty()) {
+        return rows;
+    }
+
+    QVector<int> merged;
+    std::set_union(rows.cbegin(), rows.cend(), phonetic.cbegin(), phonetic.cend(),
+                   std::back_inserter(merged));
+    return merged;
+}
+}
+
+FilterResult ProverbFilter::run(const ProverbIndex &index,
+                                const ProverbRanker &ranker, const ProverbFacets &facets,
+                                const TermDictionary &tagTerms,
+                                const CancelCheck &isCancelled) const
+{
+    // Start with search results or all proverbs
+    if (!searchText.isEmpty() && ranked) {
+        // Only rows the facets keep compete for the ranked places, and the
+        // counts cover every match rather than just those places
+        RowBitmap allowed;
+        bool restricted = !tag.isEmpty() || !region.isEmpty();
+        if (restricted) {
+            RowBitmap allowedSlots = facets.liveSlots();
+            if (!tag.isEmpty()) {
+                allowedSlots &= facets.tagRows(tagTerms.find(tag));
+            }
+            if (!region.isEmpty()) {
+                allowedSlots &= facets.regionRows(facets.regions().find(region));
+            }
+            allowed = RowBitmap::fromRows(facets.rowsOf(allowedSlots));
+        }
+
+        QVector<int> matched;
+        const QVector<ProverbRanker::Hit> hits = ranker.topK(searchText, RankedLimit, isCancelled,
+                                                             restricted ? &allowed : nullptr, &matched);
+        if (isCancelled && isCancelled()) {
+            return FilterResult();
+        }
+        QVector<int> rankedRows;
+        rankedRows.reserve(hits.size());
+        for (const ProverbRanker::Hit &hit : hits) {
+            rankedRows.append(hit.row);
+        }
+        return select(facets.slotsOf(matched), rankedRows, facets, tagTerms);
+    } else if (!searchText.isEmpty()) {
+        QVector<int> matches = substringMatches(index, searchText, isCancelled);
+        if (isCancelled && isCancelled()) {
+            return FilterResult();
+        }
+        return runWithMatches(matches, index, facets, tagTerms);
+    }
+
+    return select(facets.liveSlots(), QVector<int>(), facets, tagTerms);
+}
+
+FilterResult ProverbFilter::runWithMatches(const QVector<int> &matches, const ProverbIndex &index,
+                                           const ProverbFacets &facets,
+                                           const TermDictionary &tagTerms) const
+{
+    return select(facets.slotsOf(withPhonetic(index, searchText, matches)), QVector<int>(), facets, tagTerms);
+}
+
+QVector<int> ProverbFilter::allRows(int count)
+{
+    QVector<int> rows(count);
+    std::iota(rows.begin(), rows.end(), 0);
+    return rows;
+}
+
+QVector<int> ProverbFilter::search(const ProverbIndex &index, const QString &query,
+                                   const CancelCheck &isCancelled)
+{
+    QVector<int> matches = substringMatches(index, query, isCancelled);
+    if (isCancelled && isCancelled()) {
+        return QVector<int>();
+    }
+    return withPhonetic(index, query, matches);
+}
+
+QVector<int> ProverbFilter::substringMatches(const ProverbIndex &index, const QString &query,
+                                             const CancelCheck &isCancelled,
+                                             const QVector<int> *within)
+{
+    QVector<int> results;
+
+    if (within) {
+        // A narrower query can only keep rows the wider one matched
+        for (int i = 0; i < within->size(); ++i) {
+            if (cancelled(isCancelled, i)) {
+                return QVector<int>();
+            }
+            if (index.matches(within->at(i), query)) {
+                results.append(within->at(i));
+            }
+        }
+    } else if (!index.canAnswer(query)) {
+        // Short queries have no trigrams, so fall back to scanning every search key
+        for (int row = 0; row < index.size(); ++row) {
+            if (cancelled(isCancelled, row)) {
+                return QVector<int>();
+            }
+            if (index.matches(row, query)) {
+                results.append(row);
+            }
+        }
+    } else {
+        // Only the candidates sharing every query trigram need the full check
+        const QVector<int> candidates = index.candidates(query);
+        for (int i = 0; i < candidates.size(); ++i) {
+            if (cancelled(isCancelled, i)) {
+                return QVector<int>();
+            }
+            if (index.matches(candidates[i], query)) {
+                results.append(candidates[i]);
+            }
+        }
+    }
+
+    return results;
+}
+
+FilterResult ProverbFilter::select(const RowBitmap &base, const QVector<int> &rankedRows,
+                                   const ProverbFacets &facets,
+                                   const TermDictionary &tagTerms) const
+{
+    FilterResult result;
+
+    // Each facet is counted under the other facet's selection, so the
+    // numbers say how many rows picking that entry would leave.
+    // Unknown names resolve to an empty bitmap and so match nothing.
+    const RowBitmap &tagSelection = facets.tagRows(tagTerms.find(tag));
+    const RowBitmap &regionSelection = facets.regionRows(facets.regions().find(region));
+
+    RowBitmap forTags = base;
+    if (!region.isEmpty()) {
+        forTags &= regionSelection;
+    }
+    RowBitmap forRegions = base;
+    if (!tag.isEmpty()) {
+        forRegions &= tagSelection;
+    }
+
+    result.tagCounts.resize(tagTerms.idLimit());
+    for (int id = 0; id < result.tagCounts.size(); ++id) {
+        result.tagCounts[id] = forTags.countAnd(facets.tagRows(id));
+    }
+    result.regionCounts.resize(facets.regions().idLimit());
+    for (int id = 0; id < result.regionCounts.size(); ++id) {
+        result.regionCounts[id] = forRegions.countAnd(facets.regionRows(id));
+    }
+
+    RowBitmap selected = forTags;
+    if (!tag.isEmpty()) {
+        selected &= tagSelection;
+    }
+
+    const QVector<int> rows = facets.rowsOf(selected);
+    if (!ranked || searchText.isEmpty()) {
+        result.rows = rows;
+        return result;
+    }
+
+    // Keep the ranking order for the rows that survive the facets
+    for (int row : rankedRows) {
+        if (std::binary_search(rows.cbegin(), rows.cend(), row)) {
+            result.rows.append(row);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,68 @@
+#ifndef PROVERBFILTER_H
+#define PROVERBFILTER_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+#include "proverb.h"
+#include "proverbfacets.h"
+#include "proverbindex.h"
+#include "proverbranker.h"
+#include "termdictionary.h"
+
+// Rows matching a filter, plus per-term facet counts indexed by term id.
+// Ranked queries list rows best first; otherwise rows are in collection order.
+// A query against a ProverbDatabase fills records and total instead: the
+// first page of matching records and how many match in all.
+struct FilterResult {
+    QVector<int> rows;
+    QVector<int> tagCounts;
+    QVector<int> regionCounts;
+    QList<Proverb> records;
+    int total = 0;
+};
+
+// One search/tag/region query over the collection. run() only reads its
+// arguments, so it can be handed snapshots and executed off the GUI thread.
+struct ProverbFilter {
+    // Most rows a ranked query returns
+    static const int RankedLimit = 100;
+
+    QString searchText;   // ProverbIndex::normalize()d; empty matches everything
+    QString tag;          // empty for all tags
+    QString region;       // empty for all regions
+    bool ranked = false;  // BM25 word ranking instead of substring matching
+
+    // Polled while scanning; returning true abandons the query
+    typedef std::function<bool()> CancelCheck;
+
+    // Tag ids and counts are those of tagTerms, the records' dictionary
+    FilterResult run(const ProverbIndex &index,
+                     const ProverbRanker &ranker, const ProverbFacets &facets,
+                     const TermDictionary &tagTerms,
+                     const CancelCheck &isCancelled = CancelCheck()) const;
+    // As run() for an unranked search whose substringMatches() are known
+    FilterResult runWithMatches(const QVector<int> &matches, const ProverbIndex &index,
+                                const ProverbFacets &facets, const TermDictionary &tagTerms) const;
+
+    static QVector<int> allRows(int count);
+    // substringMatches() plus rows spelling the query in the other script
+    static QVector<int> search(const ProverbIndex &index, const QString &query,
+                               const CancelCheck &isCancelled);
+    // Sorted rows whose search key contains query. within, when given, must
+    // hold the matches of a query that query contains, since only those
+    // rows can match it too.
+    static QVector<int> substringMatches(const ProverbIndex &index, const QString &query,
+                                         const CancelCheck &isCancelled,
+                                         const QVector<int> *within = nullptr);
+
+private:
+    // base holds slots of facets; rankedRows, when given, are rows
+    FilterResult select(const RowBitmap &base, const QVector<int> &rankedRows,
+                        const ProverbFacets &facets, const TermDictionary &tagTerms) const;
+};
+
+#endif // PROVERBFILTER_H
@@ -0,0 +1,93 @@
+#include "proverbids.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+void ProverbIdIndex::build(const QList<Proverb> &proverbs)
+{
+    rowSlots.clear();
+    idSlots.clear();
+    idSlots.reserve(proverbs.size());
+    firstUnused = 1;
+
+    for (const Proverb &proverb : proverbs) {
+        append(proverb);
+    }
+}
+
+int ProverbIdIndex::rowOf(quint64 id) const
+{
+    const int *slot = idSlots.find(id);
+    return slot ? rowSlots.rowOf(*slot) : -1;
+}
+
+bool ProverbIdIndex::contains(quint64 id) const
+{
+    return idSlots.contains(id);
+}
+
+quint64 ProverbIdIndex::allocate()
+{
+    return firstUnused++;
+}
+
+quint64 ProverbIdIndex::nextId() const
+{
+    return firstUnused;
+}
+
+void ProverbIdIndex::skipTo(quint64 next)
+{
+    firstUnused = std::max(firstUnused, next);
+}
+
+void ProverbIdIndex::append(const Proverb &proverb)
+{
+    idSlots.insert(proverb.id, rowSlots.append());
+    firstUnused = std::max(firstUnused, proverb.id + 1);
+}
+
+void ProverbIdIndex::remove(quint64 id)
+{
+    int row = rowOf(id);
+    if (row < 0) {
+        return;
+    }
+
+    // Records after it keep their slots and so need no update
+    idSlots.remove(id);
+    rowSlots.remove(row);
+
+    if (rowSlots.wantsCompaction()) {
+        compact();
+    }
+}
+
+void ProverbIdIndex::compact()
+{
+    const QVector<int> renumbered = rowSlots.compact();
+    idSlots.forEachMutable([&renumbered](quint64, int &slot) {
+        slot = renumbered[slot];
+    });
+}
+
+int ProverbIdIndex::assignMissing(QList<Proverb> &proverbs)
+{
+    quint64 maxId = 0;
+    for (const Proverb &p : proverbs) {
+        maxId = std::max(maxId, p.id);
+    }
+
+    // Duplicates from hand-edited files are renumbered like missing ids
+    QSet<quint64> seen;
+    int assigned = 0;
+    for (Proverb &p : proverbs) {
+        if (p.id == 0 || seen.contains(p.id)) {
+            p.id = ++maxId;
+            ++assigned;
+        }
+        seen.insert(p.id);
+    }
+    return assigned;
+}
@@ -0,0 +1,46 @@
+#ifndef PROVERBIDS_H
+#define PROVERBIDS_H
+
+#include <QList>
+
+#include "proverb.h"
+#include "rowslots.h"
+#include "shardedhash.h"
+
+// Maps stable proverb ids to their current row in the collection.
+// Rows shift when a record is removed, ids never change. Ids map to
+// RowSlots slots, which don't shift, so a remove touches only its own id.
+class ProverbIdIndex {
+public:
+    void build(const QList<Proverb> &proverbs);
+
+    // Row of the record with this id, or -1
+    int rowOf(quint64 id) const;
+    bool contains(quint64 id) const;
+
+    // Hands out an id no record has used yet
+    quint64 allocate();
+    // The id allocate() would hand out next
+    quint64 nextId() const;
+    // Never hands out an id below next, e.g. a stored high-water mark that
+    // still covers records deleted since
+    void skipTo(quint64 next);
+
+    // The proverb as the new last row
+    void append(const Proverb &proverb);
+    void remove(quint64 id);
+
+    // Gives every record without an id (or with a duplicate one) a fresh
+    // id, numbering after the largest present so every load agrees.
+    // Returns how many ids were assigned.
+    static int assignMissing(QList<Proverb> &proverbs);
+
+private:
+    void compact();
+
+    RowSlots rowSlots;
+    ShardedHash<quint64, int> idSlots;
+    quint64 firstUnused = 1;
+};
+
+#endif // PROVERBIDS_H
@@ -0,0 +1,328 @@
+#include "proverbimporter.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QJsonDocument>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <cstring>
+
+namespace {
+enum Column {
+    ProverbColumn,
+    TransliterationColumn,
+    MeaningColumn,
+    EnglishEquivalentColumn,
+    TagsColumn,
+    RegionColumn,
+    UsageContextColumn,
+    ColumnCount,
+    IgnoredColumn = ColumnCount
+};
+
+const char *const ColumnNames[ColumnCount] = {
+    "proverb", "transliteration", "meaning", "english_equivalent",
+    "tags", "region", "usage_context"
+};
+
+const int CancelInterval = 1024;
+
+char delimiterOf(ProverbImporter::Format format)
+{
+    return format == ProverbImporter::Tsv ? '\t' : ',';
+}
+
+// Reads one delimited record starting at p and leaves p past its newline.
+// A quote opens a quoted stretch anywhere in a field, and "" inside one is
+// a literal quote, so newlines and delimiters may appear in quoted text.
+void readRecord(const char *&p, const char *end, char delimiter, QList<QByteArray> &fields)
+{
+    fields.clear();
+    QByteArray field;
+    bool quoted = false;
+
+    while (p < end) {
+        char c = *p++;
+        if (quoted) {
+            if (c != '"') {
+                field.append(c);
+            } else if (p < end && *p == '"') {
+                field.append('"');
+                ++p;
+            } else {
+                quoted = false;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == delimiter) {
+            fields.append(field);
+            field.clear();
+        } else if (c == '\n') {
+            break;
+        } else if (c != '\r') {
+            field.append(c);
+        }
+    }
+    fields.append(field);
+}
+
+bool isBlank(const QList<QByteArray> &fields)
+{
+    return fields.size() == 1 && fields.first().trimmed().isEmpty();
+}
+
+// Brings a record into the shape ProverbDialog::getProverbData() gives it
+bool normalize(Proverb &p)
+{
+    p.id = 0;
+    p.proverb = p.proverb.trimmed();
+    p.transliteration = p.transliteration.trimmed();
+    p.meaning = p.meaning.trimmed();
+    p.englishEquivalent = p.englishEquivalent.trimmed();
+    p.region = p.region.trimmed();
+    p.usageContext = p.usageContext.trimmed();
+    p.tags = Proverb::splitTags(p.tags.join(","));
+    return !p.proverb.isEmpty();
+}
+
+Proverb fromFields(const QList<QByteArray> &fields, const QList<int> &columns)
+{
+    Proverb p;
+    for (int i = 0; i < fields.size() && i < columns.size(); ++i) {
+        QString text = QString::fromUtf8(fields[i]);
+        switch (columns[i]) {
+        case ProverbColumn: p.proverb = text; break;
+        case TransliterationColumn: p.transliteration = text; break;
+        case MeaningColumn: p.meaning = text; break;
+        case EnglishEquivalentColumn: p.englishEquivalent = text; break;
+        case TagsColumn: p.tags = Proverb::splitTags(text); break;
+        case RegionColumn: p.region = text; break;
+        case UsageContextColumn: p.usageContext = text; break;
+        default: break;
+        }
+    }
+    return p;
+}
+
+// Maps a header record to columns, or returns an empty list when the first
+// record is data rather than a header
+QList<int> headerColumns(const QList<QByteArray> &fields)
+{
+    QList<int> columns;
+    bool named = false;
+    for (const QByteArray &field : fields) {
+        QByteArray name = field.trimmed().toLower();
+        int column = IgnoredColumn;
+        for (int c = 0; c < ColumnCount; ++c) {
+            if (name == ColumnNames[c]) {
+                column = c;
+            }
+        }
+        named = named || column == ProverbColumn;
+        columns.append(column);
+    }
+    return named ? columns : QList<int>();
+}
+}
+
+bool ProverbImporter::formatFor(const QString &path, Format *format)
+{
+    QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "csv") {
+        *format = Csv;
+    } else if (suffix == "tsv" || suffix == "tab") {
+        *format = Tsv;
+    } else if (suffix == "jsonl" || suffix == "ndjson") {
+        *format = JsonLines;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void ProverbImporter::run(QPromise<Result> &promise, const QString &path, Format format,
+                          const DuplicateIndex &known)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        promise.addResult(Result());
+        return;
+    }
+
+    // Chunks parse straight out of the mapping; read it in when mapping fails
+    QByteArray contents;
+    const char *begin = nullptr;
+    qint64 length = file.size();
+    if (length > 0) {
+        begin = reinterpret_cast<const char *>(file.map(0, length));
+    }
+    if (!begin) {
+        contents = file.readAll();
+        begin = contents.constData();
+        length = contents.size();
+    }
+    const char *end = begin + length;
+
+    if (length >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0) {
+        begin += 3;
+    }
+
+    QList<int> columns;
+    if (format != JsonLines) {
+        const char *body = begin;
+        QList<QByteArray> fields;
+        readRecord(body, end, delimiterOf(format), fields);
+        columns = headerColumns(fields);
+        if (columns.isEmpty()) {
+            for (int c = 0; c < ColumnCount; ++c) {
+                columns.append(c);
+            }
+        } else {
+            begin = body;
+        }
+    }
+
+    QList<Chunk> chunks = split(begin, end, format);
+    promise.setProgressRange(0, int(chunks.size()));
+    promise.setProgressValue(0);
+
+    CancelCheck isCancelled = [&promise]() {
+        return promise.isCanceled();
+    };
+
+    // A pool of our own, since this task already occupies a global one
+    QThreadPool pool;
+    QList<QFuture<Parsed>> parsed;
+    parsed.reserve(chunks.size());
+    for (const Chunk &chunk : chunks) {
+        parsed.append(QtConcurrent::run(&pool, [chunk, format, columns, &known, isCancelled]() {
+            return parse(chunk, format, columns, known, isCancelled);
+        }));
+    }
+
+    // Collected in order, so records keep their order in the file. Each
+    // record is also checked against the ones before it, which the chunks
+    // could not see; the batch index is keyed by position in the result.
+    Result result;
+    DuplicateIndex batch;
+    for (int i = 0; i < parsed.size(); ++i) {
+        Parsed part = parsed[i].result();
+        if (promise.isCanceled()) {
+            pool.waitForDone();
+            return;
+        }
+
+        for (int r = 0; r < part.signatures.size(); ++r) {
+            const DuplicateIndex::Signature &signature = part.signatures[r];
+            quint64 position = quint64(result.proverbs.size() + r) + 1;
+            if (part.knownDuplicate[r] || !batch.candidates(signature).isEmpty()) {
+                ++result.duplicates;
+            }
+            batch.insert(position, signature);
+        }
+
+        result.proverbs.append(std::move(part.result.proverbs));
+        result.rejected += part.result.rejected;
+        promise.setProgressValue(i + 1);
+    }
+
+    promise.addResult(std::move(result));
+}
+
+QList<ProverbImporter::Chunk> ProverbImporter::split(const char *begin, const char *end,
+                                                      Format format)
+{
+    QList<Chunk> chunks;
+    const char *start = begin;
+
+    if (format == JsonLines) {
+        // JSON strings cannot hold a raw newline, so any newline ends a record
+        while (end - start > ChunkSize) {
+            const void *newline = std::memchr(start + ChunkSize, '\n', size_t(end - start - ChunkSize));
+            if (!newline) {
+                break;
+            }
+            const char *next = static_cast<const char *>(newline) + 1;
+            chunks.append(Chunk{start, next});
+            start = next;
+        }
+    } else {
+        // Quoted newlines belong to their record, so track the quoting
+        bool quoted = false;
+        for (const char *p = start; p < end; ++p) {
+            if (*p == '"') {
+                quoted = !quoted;
+            } else if (*p == '\n' && !quoted && p + 1 - start >= ChunkSize) {
+                chunks.append(Chunk{start, p + 1});
+                start = p + 1;
+            }
+        }
+    }
+
+    if (start < end) {
+        chunks.append(Chunk{start, end});
+    }
+    return chunks;
+}
+
+ProverbImporter::Parsed ProverbImporter::parse(const Chunk &chunk, Format format,
+                                               const QList<int> &columns,
+                                               const DuplicateIndex &known,
+                                               const CancelCheck &isCancelled)
+{
+    Parsed parsed;
+    Result &result = parsed.result;
+    const char *p = chunk.begin;
+    int records = 0;
+
+    QList<QByteArray> fields;
+    while (p < chunk.end) {
+        if (isCancelled && ++records % CancelInterval == 0 && isCancelled()) {
+            return Parsed();
+        }
+
+        Proverb proverb;
+        if (format == JsonLines) {
+            const char *newline = static_cast<const char *>(std::memchr(p, '\n', size_t(chunk.end - p)));
+            const char *lineEnd = newline ? newline : chunk.end;
+            QByteArray line = QByteArray::fromRawData(p, lineEnd - p).trimmed();
+            p = newline ? newline + 1 : chunk.end;
+            if (line.isEmpty()) {
+                continue;
+            }
+
+            QJsonParseError error;
+            QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+            if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+                ++result.rejected;
+                continue;
+            }
+
+            QJsonObject object = doc.object();
+            proverb = Proverb::fromJson(object);
+            if (object["tags"].isString()) {
+                proverb.tags = Proverb::splitTags(object["tags"].toString());
+            }
+        } else {
+            readRecord(p, chunk.end, delimiterOf(format), fields);
+            if (isBlank(fields)) {
+                continue;
+            }
+            proverb = fromFields(fields, columns);
+        }
+
+        if (!normalize(proverb)) {
+            ++result.rejected;
+            continue;
+        }
+
+        DuplicateIndex::Signature signature = DuplicateIndex::signature(proverb.proverb, proverb.transliteration);
+        parsed.signatures.append(signature);
+        parsed.knownDuplicate.append(known.size() > 0 && !known.candidates(signature).isEmpty());
+        result.proverbs.append(proverb);
+    }
+
+    return parsed;
+}
@@ -0,0 +1,70 @@
+#ifndef PROVERBIMPORTER_H
+#define PROVERBIMPORTER_H
+
+#include <QList>
+#include <QPromise>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+#include "duplicateindex.h"
+#include "proverb.h"
+
+// Bulk import of CSV, TSV and JSON Lines files. The file is mapped and cut
+// into chunks on record boundaries, the chunks are parsed in parallel, and
+// the records come back in file order with trimmed fields and comma-split
+// tags, just as ProverbDialog produces them.
+//
+// Delimited files may start with a header naming the columns after the
+// JSON keys (proverb, transliteration, meaning, english_equivalent, tags,
+// region, usage_context); without one the columns are taken in that order.
+// Quoting follows RFC 4180 in both CSV and TSV.
+class ProverbImporter {
+public:
+    enum Format {
+        Csv,
+        Tsv,
+        JsonLines
+    };
+
+    struct Result {
+        QList<Proverb> proverbs;    // without ids, ready for ProverbStore::addAll()
+        int rejected = 0;           // malformed lines and records without proverb text
+        int duplicates = 0;         // records resembling one already known or earlier in the file
+    };
+
+    typedef std::function<bool()> CancelCheck;
+
+    static const qint64 ChunkSize = 4 * 1024 * 1024;
+
+    // Picks the format from the file suffix; false when it is not one we read
+    static bool formatFor(const QString &path, Format *format);
+
+    // Reads and parses path, reporting progress in chunks and stopping early
+    // once cancelled. Each record is also checked against known, the
+    // collection's duplicate index, and against the records before it in
+    // the file. Meant to be started with QtConcurrent::run().
+    static void run(QPromise<Result> &promise, const QString &path, Format format,
+                    const DuplicateIndex &known);
+
+private:
+    struct Chunk {
+        const char *begin;
+        const char *end;
+    };
+
+    // A parsed chunk with each record's signature, kept for the check
+    // across chunks, and whether it already resembles a known record
+    struct Parsed {
+        Result result;
+        QVector<DuplicateIndex::Signature> signatures;
+        QVector<bool> knownDuplicate;
+    };
+
+    static QList<Chunk> split(const char *begin, const char *end, Format format);
+    static Parsed parse(const Chunk &chunk, Format format, const QList<int> &columns,
+                        const DuplicateIndex &known, const CancelCheck &isCancelled);
+};
+
+#endif // PROVERBIMPORTER_H
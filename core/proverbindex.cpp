@@ -0,0 +1,232 @@
+#include "proverbindex.h"
+
+#include "utf16search.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+// Joins the fields of a search key. Normalized queries never contain it, so
+// a match cannot straddle two fields.
+const QChar FieldSeparator(0x1F);
+}
+
+void ProverbIndex::build(const QList<Proverb> &proverbs)
+{
+    clear();
+    slotGrams.reserve(proverbs.size());
+    slotKeys.reserve(proverbs.size());
+
+    for (const Proverb &p : proverbs) {
+        append(p);
+    }
+}
+
+void ProverbIndex::clear()
+{
+    rowSlots.clear();
+    postings.clear();
+    slotGrams.clear();
+    slotKeys.clear();
+    phonetic.clear();
+}
+
+void ProverbIndex::append(const Proverb &proverb)
+{
+    int slot = rowSlots.append();
+    QString key = searchKey(proverb);
+    slotKeys.append(QStringView(key).utf16(), int(key.size()));
+    slotGrams.append(gramsFor(key));
+    addPostings(slot, slotGrams.last());
+    phonetic.append(proverb);
+}
+
+void ProverbIndex::update(int row, const Proverb &proverb)
+{
+    if (row < 0 || row >= rowSlots.size()) {
+        return;
+    }
+
+    // Only grams the edit adds or drops touch their posting lists
+    int slot = rowSlots.slotOf(row);
+    QString key = searchKey(proverb);
+    QVector<Gram> grams = gramsFor(key);
+    const QVector<Gram> &old = slotGrams.at(slot);
+    QVector<Gram> dropped;
+    QVector<Gram> added;
+    std::set_difference(old.cbegin(), old.cend(), grams.cbegin(), grams.cend(), std::back_inserter(dropped));
+    std::set_difference(grams.cbegin(), grams.cend(), old.cbegin(), old.cend(), std::back_inserter(added));
+
+    removePostings(slot, dropped);
+    addPostings(slot, added);
+    slotKeys.set(slot, QStringView(key).utf16(), int(key.size()));
+    slotGrams[slot] = grams;
+    phonetic.update(row, proverb);
+}
+
+void ProverbIndex::remove(int row)
+{
+    if (row < 0 || row >= rowSlots.size()) {
+        return;
+    }
+
+    // Later records keep their slots, so no other posting changes
+    int slot = rowSlots.remove(row);
+    removePostings(slot, slotGrams.at(slot));
+    slotGrams[slot] = QVector<Gram>();
+    slotKeys.set(slot, nullptr, 0);
+    phonetic.remove(row);
+
+    if (rowSlots.wantsCompaction()) {
+        compact();
+    }
+}
+
+int ProverbIndex::size() const
+{
+    return rowSlots.size();
+}
+
+QString ProverbIndex::normalize(const QString &text)
+{
+    return text.normalized(QString::NormalizationForm_KC).toCaseFolded();
+}
+
+bool ProverbIndex::canAnswer(const QString &query) const
+{
+    return query.size() >= GramSize;
+}
+
+QVector<int> ProverbIndex::candidates(const QString &query) const
+{
+    QVector<Gram> grams;
+    collectGrams(query, grams);
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+    // Gather the posting lists; a missing gram means nothing can match
+    QVector<const QVector<int> *> lists;
+    lists.reserve(grams.size());
+    for (Gram gram : grams) {
+        const QVector<int> *list = postings.find(gram);
+        if (!list) {
+            return QVector<int>();
+        }
+        lists.append(list);
+    }
+
+    if (lists.isEmpty()) {
+        return QVector<int>();
+    }
+
+    // Intersect starting from the shortest list so the working set stays small
+    std::sort(lists.begin(), lists.end(), [](const QVector<int> *a, const QVector<int> *b) {
+        return a->size() < b->size();
+    });
+
+    QVector<int> result = *lists.first();
+    QVector<int> scratch;
+    for (int i = 1; i < lists.size() && !result.isEmpty(); ++i) {
+        scratch.clear();
+        std::set_intersection(result.cbegin(), result.cend(),
+                              lists[i]->cbegin(), lists[i]->cend(),
+                              std::back_inserter(scratch));
+        result.swap(scratch);
+    }
+
+    return rowSlots.toRows(result);
+}
+
+bool ProverbIndex::matches(int row, const QString &query) const
+{
+    if (row < 0 || row >= rowSlots.size()) {
+        return false;
+    }
+    int slot = rowSlots.slotOf(row);
+    return utf16Contains(QStringView(slotKeys.data(slot), slotKeys.length(slot)), query);
+}
+
+QVector<int> ProverbIndex::phoneticMatches(const QString &query) const
+{
+    return phonetic.rows(query);
+}
+
+QString ProverbIndex::searchKey(const Proverb &proverb)
+{
+    QString key = proverb.proverb;
+    key += FieldSeparator;
+    key += proverb.transliteration;
+    key += FieldSeparator;
+    key += proverb.meaning;
+    for (const QString &tag : proverb.tags) {
+        key += FieldSeparator;
+        key += tag;
+    }
+    return normalize(key);
+}
+
+void ProverbIndex::collectGrams(const QString &text, QVector<Gram> &grams)
+{
+    const QChar *data = text.constData();
+    for (int i = 0; i + GramSize <= text.size(); ++i) {
+        Gram gram = (Gram(data[i].unicode()) << 32) |
+                    (Gram(data[i + 1].unicode()) << 16) |
+                    Gram(data[i + 2].unicode());
+        grams.append(gram);
+    }
+}
+
+QVector<ProverbIndex::Gram> ProverbIndex::gramsFor(const QString &key)
+{
+    // Grams spanning a separator are harmless: no query can produce them
+    QVector<Gram> grams;
+    collectGrams(key, grams);
+
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+void ProverbIndex::addPostings(int slot, const QVector<Gram> &grams)
+{
+    for (Gram gram : grams) {
+        QVector<int> &list = postings[gram];
+        if (list.isEmpty() || list.last() < slot) {
+            list.append(slot);
+        } else {
+            auto pos = std::lower_bound(list.begin(), list.end(), slot);
+            if (pos == list.end() || *pos != slot) {
+                list.insert(pos, slot);
+            }
+        }
+    }
+}
+
+void ProverbIndex::removePostings(int slot, const QVector<Gram> &grams)
+{
+    for (Gram gram : grams) {
+        QVector<int> *list = postings.find(gram);
+        if (!list) {
+            continue;
+        }
+
+        auto pos = std::lower_bound(list->begin(), list->end(), slot);
+        if (pos != list->end() && *pos == slot) {
+            list->erase(pos);
+        }
+        if (list->isEmpty()) {
+            postings.remove(gram);
+        }
+    }
+}
+
+void ProverbIndex::compact()
+{
+    // Postings only hold live slots, and renumbering keeps them sorted
+    const QVector<int> renumbered = rowSlots.compact();
+    postings.forEachMutable([&renumbered](Gram, QVector<int> &list) {
+        RowSlots::renumber(list, renumbered);
+    });
+    slotGrams = RowSlots::keepLive(slotGrams, renumbered);
+    slotKeys.keepLive(renumbered);
+}
@@ -0,0 +1,75 @@
+#ifndef PROVERBINDEX_H
+#define PROVERBINDEX_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "arenacolumn.h"
+#include "chunkedvector.h"
+#include "phoneticindex.h"
+#include "proverb.h"
+#include "rowslots.h"
+#include "shardedhash.h"
+
+// Trigram inverted index over the searchable proverb fields.
+// Rows are positions in the owning collection; the caller keeps the
+// index in step with it through append/update/remove. Inside, records are
+// kept by RowSlots slot, so a remove only drops the record's own postings.
+//
+// Each row also keeps a search key: its searchable fields normalized once
+// with normalize() and joined, so matching a query never re-folds a record.
+// The keys share one arena, so the linear fallback scans contiguous memory.
+// The words of the proverb and transliteration go in a PhoneticIndex.
+class ProverbIndex {
+public:
+    static const int GramSize = 3;
+
+    void build(const QList<Proverb> &proverbs);
+    void clear();
+
+    void append(const Proverb &proverb);
+    void update(int row, const Proverb &proverb);
+    void remove(int row);
+
+    int size() const;
+
+    // NFKC followed by case folding, so compatibility forms, precomposed and
+    // decomposed letters and case variants all compare equal. Queries must
+    // be passed through this before candidates() and matches().
+    static QString normalize(const QString &text);
+
+    // Queries shorter than a trigram cannot be answered from the index
+    bool canAnswer(const QString &query) const;
+
+    // Sorted rows whose fields contain every trigram of the normalized
+    // query. This is a superset of the real matches; use matches() to verify.
+    QVector<int> candidates(const QString &query) const;
+
+    // Substring test of a normalized query against the row's search key,
+    // used both to verify candidates and for the linear fallback
+    bool matches(int row, const QString &query) const;
+
+    // Rows whose words sound like the query's, across Devanagari and Latin
+    QVector<int> phoneticMatches(const QString &query) const;
+
+    // The normalized searchable fields, joined by a separator no query holds
+    static QString searchKey(const Proverb &proverb);
+
+private:
+    typedef quint64 Gram;
+
+    static void collectGrams(const QString &text, QVector<Gram> &grams);
+    static QVector<Gram> gramsFor(const QString &key);
+    void addPostings(int slot, const QVector<Gram> &grams);
+    void removePostings(int slot, const QVector<Gram> &grams);
+    void compact();
+
+    RowSlots rowSlots;
+    ShardedHash<Gram, QVector<int>> postings;   // sorted slots
+    ChunkedVector<QVector<Gram>> slotGrams;
+    ArenaColumn<char16_t> slotKeys;
+    PhoneticIndex phonetic;
+};
+
+#endif // PROVERBINDEX_H
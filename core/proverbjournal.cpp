@@ -0,0 +1,469 @@
+#include "proverbjournal.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+ProverbJournal::ProverbJournal(const QString &snapshotPath)
+    : snapshotPath(snapshotPath),
+    journalPath(snapshotPath + ".journal")
+{
+}
+
+ProverbJournal::~ProverbJournal()
+{
+    waitForCompaction();
+    journalFile.close();
+}
+
+bool ProverbJournal::load(QList<Proverb> &proverbs, LoadMode mode)
+{
+    waitForCompaction();
+    journalFile.close();
+
+    // A reader can't promote a finished compaction, so it reads the ready
+    // snapshot where it is; that already covers every rotated journal
+    QString source = snapshotPath;
+    if (mode == ReadWrite) {
+        recover();
+    } else if (QFile::exists(snapshotPath + ".ready")) {
+        source = snapshotPath + ".ready";
+    }
+    QStringList rotated = source == snapshotPath ? rotatedJournals() : QStringList();
+
+    bool found = false;
+    Manifest manifest = readManifest(snapshotPath);
+    QString binaryPath = manifest.binary.isEmpty() ? QString()
+                                                   : QFileInfo(snapshotPath).dir().filePath(manifest.binary);
+
+    // A fresh mapping each time, as records from the last load may still
+    // be reading the previous one
+    binarySnapshot.reset(new ProverbSnapshot);
+
+    if (source == snapshotPath && !binaryPath.isEmpty() && binarySnapshot->open(binaryPath, snapshotPath)) {
+        // Fields are read straight out of the mapping without parsing
+        proverbs.reserve(proverbs.size() + binarySnapshot->size());
+        for (int i = 0; i < binarySnapshot->size(); ++i) {
+            proverbs.append(binarySnapshot->proverb(i));
+        }
+        found = true;
+    } else {
+        binarySnapshot.reset();
+        QFile file(source);
+
+        if (file.open(QIODevice::ReadOnly)) {
+            QList<Proverb> parsed;
+            {
+                QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+                for (const QJsonValue &value : doc.array()) {
+                    parsed.append(Proverb::fromJson(value.toObject()));
+                }
+            }
+            file.close();
+            found = true;
+
+            // Rebuild the cache so the next start can skip the JSON parse,
+            // and read this one back through it too: the parsed copies are
+            // dropped and details stay lazy from the first start on
+            if (mode == ReadWrite) {
+                QString binary = writeBinary(snapshotPath, parsed, QFileInfo(snapshotPath).size());
+                Manifest rebuilt = manifest;
+                rebuilt.binary = binary;
+                if (!binary.isEmpty() && writeManifest(snapshotPath, rebuilt)) {
+                    removeStaleBinaries(snapshotPath, binary);
+                    binarySnapshot.reset(new ProverbSnapshot);
+                    if (binarySnapshot->open(QFileInfo(snapshotPath).dir().filePath(binary), snapshotPath) &&
+                        binarySnapshot->size() == parsed.size()) {
+                        for (int i = 0; i < parsed.size(); ++i) {
+                            parsed[i] = binarySnapshot->proverb(i);
+                        }
+                    } else {
+                        binarySnapshot.reset();
+                    }
+                }
+            }
+            proverbs.append(std::move(parsed));
+        }
+    }
+
+    // Journal records address proverbs by id, so ids must exist first
+    int assigned = ProverbIdIndex::assignMissing(proverbs);
+    ProverbIdIndex ids;
+    ids.build(proverbs);
+    ids.skipTo(manifest.nextId);
+
+    // Rotated journals predate the live one, so they replay first
+    for (const QString &path : std::as_const(rotated)) {
+        found = replay(path, proverbs, ids) || found;
+    }
+    found = replay(journalPath, proverbs, ids) || found;
+    firstUnusedId = ids.nextId();
+
+    if (mode == ReadOnly) {
+        return found;
+    }
+
+    openJournal();
+
+    if (assigned > 0) {
+        writeSnapshot(ProverbColumns::fromList(proverbs));
+    } else if (found && needsCompaction()) {
+        // Journals left behind by an interrupted compaction are folded in now
+        compactIfNeeded(ProverbColumns::fromList(proverbs));
+    }
+
+    return found;
+}
+
+QSharedPointer<const ProverbSnapshot> ProverbJournal::mappedSnapshot() const
+{
+    return binarySnapshot;
+}
+
+quint64 ProverbJournal::nextId() const
+{
+    return firstUnusedId;
+}
+
+bool ProverbJournal::appendAdd(const Proverb &proverb)
+{
+    firstUnusedId = std::max(firstUnusedId, proverb.id + 1);
+
+    QJsonObject record;
+    record["op"] = "add";
+    record["proverb"] = proverb.toJson();
+    return append(record);
+}
+
+bool ProverbJournal::appendEdit(const Proverb &proverb)
+{
+    firstUnusedId = std::max(firstUnusedId, proverb.id + 1);
+    QJsonObject record;
+    record["op"] = "edit";
+    record["id"] = qint64(proverb.id);
+    record["proverb"] = proverb.toJson();
+    return append(record);
+}
+
+bool ProverbJournal::appendRemove(quint64 id)
+{
+    firstUnusedId = std::max(firstUnusedId, id + 1);
+    QJsonObject record;
+    record["op"] = "delete";
+    record["id"] = qint64(id);
+    return append(record);
+}
+
+bool ProverbJournal::writeSnapshot(const ProverbColumns &proverbs, const RowFilter &rows)
+{
+    waitForCompaction();
+    for (int row = 0; row < proverbs.size(); ++row) {
+        firstUnusedId = std::max(firstUnusedId, proverbs.id(row) + 1);
+    }
+    return compact(snapshotPath, proverbs, rows, rotateJournal(), firstUnusedId);
+}
+
+QFuture<bool> ProverbJournal::writeSnapshotAsync(const ProverbColumns &proverbs, const RowFilter &rows)
+{
+    waitForCompaction();
+
+    // Rows other writers keep still raise the mark, which only makes it safer
+    for (int row = 0; row < proverbs.size(); ++row) {
+        firstUnusedId = std::max(firstUnusedId, proverbs.id(row) + 1);
+    }
+
+    // The column copy is implicitly shared, so the worker sees this exact state
+    QString path = snapshotPath;
+    QStringList rotated = rotateJournal();
+    ProverbColumns snapshot = proverbs;
+    quint64 nextId = firstUnusedId;
+    compaction = QtConcurrent::run([path, snapshot, rows, rotated, nextId]() {
+        return compact(path, snapshot, rows, rotated, nextId);
+    });
+    return compaction;
+}
+
+void ProverbJournal::compactIfNeeded(const ProverbColumns &proverbs, const RowFilter &rows)
+{
+    if (compaction.isRunning() || !needsCompaction()) {
+        return;
+    }
+
+    writeSnapshotAsync(proverbs, rows);
+}
+
+void ProverbJournal::waitForCompaction()
+{
+    compaction.waitForFinished();
+}
+
+bool ProverbJournal::needsCompaction() const
+{
+    return journalFile.size() >= CompactionThreshold || !rotatedJournals().isEmpty();
+}
+
+bool ProverbJournal::append(const QJsonObject &record)
+{
+    if (!journalFile.isOpen() && !openJournal()) {
+        return false;
+    }
+
+    QByteArray line = QJsonDocument(record).toJson(QJsonDocument::Compact);
+    line.append('\n');
+
+    return journalFile.write(line) == line.size() && syncFile(journalFile);
+}
+
+bool ProverbJournal::openJournal()
+{
+    journalFile.setFileName(journalPath);
+    if (!journalFile.open(QIODevice::ReadWrite | QIODevice::Append)) {
+        return false;
+    }
+
+    // Terminate a record torn by a crash so the next one starts on its own line
+    if (journalFile.size() > 0) {
+        char last = 0;
+        journalFile.seek(journalFile.size() - 1);
+        journalFile.getChar(&last);
+        if (last != '\n') {
+            journalFile.write("\n");
+        }
+    }
+
+    return true;
+}
+
+QStringList ProverbJournal::rotateJournal()
+{
+    journalFile.close();
+
+    QStringList rotated = rotatedJournals();
+
+    if (QFileInfo(journalPath).size() > 0) {
+        int next = 1;
+        if (!rotated.isEmpty()) {
+            next = rotated.last().section('.', -1).toInt() + 1;
+        }
+
+        QString target = snapshotPath + ".compacting." + QString::number(next);
+        if (QFile::rename(journalPath, target)) {
+            rotated.append(target);
+        }
+    }
+
+    openJournal();
+    return rotated;
+}
+
+QStringList ProverbJournal::rotatedJournals() const
+{
+    QFileInfo info(snapshotPath);
+    QDir dir = info.absoluteDir();
+    QStringList names = dir.entryList({info.fileName() + ".compacting.*"}, QDir::Files);
+
+    std::sort(names.begin(), names.end(), [](const QString &a, const QString &b) {
+        return a.section('.', -1).toInt() < b.section('.', -1).toInt();
+    });
+
+    QStringList paths;
+    for (const QString &name : names) {
+        paths.append(dir.filePath(name));
+    }
+    return paths;
+}
+
+void ProverbJournal::recover()
+{
+    // A ready snapshot already covers every rotated journal
+    if (QFile::exists(snapshotPath + ".ready")) {
+        promoteReady(snapshotPath, rotatedJournals());
+    }
+}
+
+bool ProverbJournal::replay(const QString &path, QList<Proverb> &proverbs, ProverbIdIndex &ids)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        // Skip records torn by a crash mid-append
+        QJsonParseError error;
+        QJsonObject record = QJsonDocument::fromJson(line, &error).object();
+        if (error.error != QJsonParseError::NoError) {
+            continue;
+        }
+
+        QString op = record["op"].toString();
+        Proverb proverb = Proverb::fromJson(record["proverb"].toObject());
+
+        // Records written before ids existed carry a row instead
+        int row = record.contains("id") ? ids.rowOf(quint64(record["id"].toInteger()))
+                                        : record["row"].toInt(-1);
+
+        if (op == "add") {
+            if (proverb.id == 0) {
+                proverb.id = ids.allocate();
+            }
+
+            // Replaying an add twice must not duplicate the record
+            int existing = ids.rowOf(proverb.id);
+            if (existing >= 0) {
+                proverbs[existing] = proverb;
+            } else {
+                proverbs.append(proverb);
+                ids.append(proverb);
+            }
+        } else if (op == "edit" && row >= 0 && row < proverbs.size()) {
+            proverb.id = proverbs[row].id;
+            proverbs[row] = proverb;
+        } else if (op == "delete" && row >= 0 && row < proverbs.size()) {
+            quint64 id = proverbs[row].id;
+            proverbs.removeAt(row);
+            ids.remove(id);
+        }
+    }
+
+    file.close();
+    return true;
+}
+
+bool ProverbJournal::compact(const QString &snapshotPath, const ProverbColumns &proverbs,
+                             const RowFilter &rows, const QStringList &rotated, quint64 nextId)
+{
+    QList<Proverb> records;
+    records.reserve(rows ? 0 : proverbs.size());
+    QJsonArray jsonArray;
+    for (int row = 0; row < proverbs.size(); ++row) {
+        if (rows && !rows(proverbs, row)) {
+            continue;
+        }
+        records.append(proverbs.proverb(row));
+        jsonArray.append(records.last().toJson());
+    }
+
+    // QSaveFile discards its temp file on failure, so .ready is all or nothing
+    QSaveFile file(snapshotPath + ".ready");
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QByteArray data = QJsonDocument(jsonArray).toJson();
+    if (file.write(data) != data.size() || !file.commit()) {
+        return false;
+    }
+
+    // Keep the binary cache current so the next start can still map it.
+    // It is written after .ready, so it is no older than the JSON.
+    Manifest manifest;
+    manifest.nextId = nextId;
+    manifest.binary = writeBinary(snapshotPath, records, data.size());
+
+    // The journals about to go may hold the only trace of a deleted id, so
+    // the mark is stored first; a mark ahead of the snapshot is harmless
+    if (!writeManifest(snapshotPath, manifest)) {
+        return false;
+    }
+    promoteReady(snapshotPath, rotated);
+    removeStaleBinaries(snapshotPath, manifest.binary);
+    return true;
+}
+
+ProverbJournal::Manifest ProverbJournal::readManifest(const QString &snapshotPath)
+{
+    Manifest manifest;
+    QFile file(snapshotPath + ".manifest");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return manifest;
+    }
+
+    QJsonObject object = QJsonDocument::fromJson(file.readAll()).object();
+    manifest.nextId = quint64(std::max<qint64>(1, object["nextId"].toInteger()));
+    manifest.binary = object["binary"].toString();
+    return manifest;
+}
+
+bool ProverbJournal::writeManifest(const QString &snapshotPath, const Manifest &manifest)
+{
+    QJsonObject object;
+    object["nextId"] = qint64(manifest.nextId);
+    if (!manifest.binary.isEmpty()) {
+        object["binary"] = manifest.binary;
+    }
+
+    QByteArray data = QJsonDocument(object).toJson();
+    QSaveFile file(snapshotPath + ".manifest");
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit();
+}
+
+QString ProverbJournal::writeBinary(const QString &snapshotPath, const QList<Proverb> &records,
+                                    qint64 sourceSize)
+{
+    // Past every cache still on disk, so none that may be mapped is touched
+    QFileInfo info(snapshotPath);
+    QDir dir = info.absoluteDir();
+    int version = 0;
+    const QStringList names = dir.entryList({info.fileName() + ".bin.*"}, QDir::Files);
+    for (const QString &name : names) {
+        version = std::max(version, name.section('.', -1).toInt());
+    }
+
+    QString name = info.fileName() + ".bin." + QString::number(version + 1);
+    return ProverbSnapshot::write(dir.filePath(name), records, sourceSize) ? name : QString();
+}
+
+void ProverbJournal::removeStaleBinaries(const QString &snapshotPath, const QString &current)
+{
+    // A cache still mapped somewhere can't be removed on Windows; it is
+    // left for a later call
+    QFileInfo info(snapshotPath);
+    QDir dir = info.absoluteDir();
+    const QStringList names = dir.entryList({info.fileName() + ".bin", info.fileName() + ".bin.*"},
+                                            QDir::Files);
+    for (const QString &name : names) {
+        if (name != current) {
+            dir.remove(name);
+        }
+    }
+}
+
+void ProverbJournal::promoteReady(const QString &snapshotPath, const QStringList &rotated)
+{
+    for (const QString &path : rotated) {
+        QFile::remove(path);
+    }
+
+    QFile::remove(snapshotPath);
+    QFile::rename(snapshotPath + ".ready", snapshotPath);
+}
+
+bool ProverbJournal::syncFile(QFile &file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
@@ -0,0 +1,123 @@
+#ifndef PROVERBJOURNAL_H
+#define PROVERBJOURNAL_H
+
+#include <QFile>
+#include <QFuture>
+#include <QJsonObject>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+#include "proverb.h"
+#include "proverbcolumns.h"
+#include "proverbids.h"
+#include "proverbsnapshot.h"
+
+// Write-ahead journal layered over the JSON snapshot. Each mutation is
+// appended as one JSON line and synced; load() replays the journal on top
+// of the snapshot, and compaction folds it back into a fresh snapshot.
+//
+// Files next to the snapshot:
+//   <snapshot>.journal        live journal receiving new records
+//   <snapshot>.compacting.N   journals rotated out by a compaction in progress
+//   <snapshot>.ready          complete snapshot covering every rotated journal
+//   <snapshot>.bin.N          mapped binary cache of the snapshot, rebuilt
+//                             whenever the JSON is newer
+//   <snapshot>.manifest       the id high-water mark, so ids of deleted
+//                             records are not handed out again, and the
+//                             name of the current .bin.N
+// .ready is written through QSaveFile, so it only appears once complete
+// and synced. That rename is the commit point, and a crash at any step is
+// recovered by the next load(). A cache is never replaced in place, since
+// readers may still map it and Windows can't rename over a mapped file:
+// each rebuild gets the next N, the manifest switches to it, and older
+// ones are removed once nothing maps them any more.
+class ProverbJournal {
+public:
+    static const qint64 CompactionThreshold = 1024 * 1024;
+
+    // Picks the rows of the columns a snapshot holds; all of them when unset
+    typedef std::function<bool(const ProverbColumns &, int)> RowFilter;
+
+    enum LoadMode {
+        ReadWrite,
+        ReadOnly    // for readers sharing the files with a writer
+    };
+
+    explicit ProverbJournal(const QString &snapshotPath);
+    ~ProverbJournal();
+
+    // Reads the snapshot and replays pending journals into proverbs.
+    // Records from older files are given ids, and the snapshot is rewritten
+    // once so those ids stay stable. ReadOnly leaves every file as it was:
+    // ids are only given in memory, no journal is opened, no cache rebuilt
+    // and nothing compacted, and a .ready snapshot is read in place of the
+    // one it is due to replace. Returns false when there is no stored
+    // collection at all.
+    bool load(QList<Proverb> &proverbs, LoadMode mode = ReadWrite);
+
+    // Binary snapshot the last load() mapped. A ReadWrite load that had to
+    // parse the JSON writes the cache and maps that, so this is only null
+    // for a ReadOnly load without a current cache or when the write failed.
+    // Loaded strings point into it, and sharing it keeps the mapping alive
+    // for as long as anything still reads from it.
+    QSharedPointer<const ProverbSnapshot> mappedSnapshot() const;
+
+    // An id after every one the snapshot and journals have held, deleted
+    // records included, as of the last load() or append
+    quint64 nextId() const;
+
+    bool appendAdd(const Proverb &proverb);
+    bool appendEdit(const Proverb &proverb);
+    bool appendRemove(quint64 id);
+
+    // Synchronously replaces the snapshot and empties the journal
+    bool writeSnapshot(const ProverbColumns &proverbs, const RowFilter &rows = RowFilter());
+    // Empties the journal now and writes the snapshot on a worker thread.
+    // The columns are an implicitly shared copy, so later edits don't
+    // reach the write.
+    QFuture<bool> writeSnapshotAsync(const ProverbColumns &proverbs,
+                                     const RowFilter &rows = RowFilter());
+
+    // Starts a background compaction once the journal is large enough
+    void compactIfNeeded(const ProverbColumns &proverbs, const RowFilter &rows = RowFilter());
+    void waitForCompaction();
+
+private:
+    bool needsCompaction() const;
+    bool append(const QJsonObject &record);
+    bool openJournal();
+    QStringList rotateJournal();
+    QStringList rotatedJournals() const;
+    void recover();
+
+    static bool replay(const QString &path, QList<Proverb> &proverbs, ProverbIdIndex &ids);
+    static bool compact(const QString &snapshotPath, const ProverbColumns &proverbs,
+                        const RowFilter &rows, const QStringList &rotated, quint64 nextId);
+    struct Manifest {
+        quint64 nextId = 1;
+        QString binary;     // file name of the current cache, if any
+    };
+
+    static Manifest readManifest(const QString &snapshotPath);
+    static bool writeManifest(const QString &snapshotPath, const Manifest &manifest);
+    // Writes the cache under the next free .bin.N; returns its file name,
+    // or an empty one when the write failed
+    static QString writeBinary(const QString &snapshotPath, const QList<Proverb> &records,
+                               qint64 sourceSize);
+    static void removeStaleBinaries(const QString &snapshotPath, const QString &current);
+    static void promoteReady(const QString &snapshotPath, const QStringList &rotated);
+    static bool syncFile(QFile &file);
+
+    QString snapshotPath;
+    QString journalPath;
+    QFile journalFile;
+    QSharedPointer<ProverbSnapshot> binarySnapshot;
+    quint64 firstUnusedId = 1;
+    QFuture<bool> compaction;
+};
+
+#endif // PROVERBJOURNAL_H
@@ -0,0 +1,294 @@
+#include "proverbranker.h"
+
+#include "proverbindex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+// Standard BM25 saturation and length normalization parameters
+const float K1 = 1.2f;
+const float B = 0.75f;
+
+// How many postings are scored between cancellation checks
+const int CancelInterval = 1024;
+
+// Orders the heap so its top is the weakest hit kept so far
+bool strongerHit(const ProverbRanker::Hit &a, const ProverbRanker::Hit &b)
+{
+    return a.score > b.score || (a.score == b.score && a.row < b.row);
+}
+}
+
+ProverbRanker::ProverbRanker()
+{
+    std::fill(totalLengths, totalLengths + FieldCount, 0);
+
+    // The proverb and its romanization say the most about what it is
+    weights[ProverbText] = 3.0f;
+    weights[Transliteration] = 2.5f;
+    weights[Meaning] = 1.5f;
+    weights[EnglishEquivalent] = 1.5f;
+    weights[UsageContext] = 1.0f;
+}
+
+void ProverbRanker::build(const QList<Proverb> &proverbs)
+{
+    clear();
+    slotStats.reserve(proverbs.size());
+
+    for (const Proverb &p : proverbs) {
+        append(p);
+    }
+}
+
+void ProverbRanker::clear()
+{
+    rowSlots.clear();
+    postings.clear();
+    slotStats.clear();
+    std::fill(totalLengths, totalLengths + FieldCount, 0);
+}
+
+void ProverbRanker::append(const Proverb &proverb)
+{
+    int slot = rowSlots.append();
+    slotStats.append(RowStats());
+    addRow(slot, statsFor(proverb));
+}
+
+void ProverbRanker::update(int row, const Proverb &proverb)
+{
+    if (row < 0 || row >= rowSlots.size()) {
+        return;
+    }
+
+    int slot = rowSlots.slotOf(row);
+    removeRow(slot);
+    addRow(slot, statsFor(proverb));
+}
+
+void ProverbRanker::remove(int row)
+{
+    if (row < 0 || row >= rowSlots.size()) {
+        return;
+    }
+
+    // Later records keep their slots, so no other posting changes
+    removeRow(rowSlots.remove(row));
+
+    if (rowSlots.wantsCompaction()) {
+        compact();
+    }
+}
+
+void ProverbRanker::setWeight(Field field, float weight)
+{
+    weights[field] = qMax(0.0f, weight);
+}
+
+float ProverbRanker::weight(Field field) const
+{
+    return weights[field];
+}
+
+QVector<ProverbRanker::Hit> ProverbRanker::topK(const QString &query, int limit,
+                                                const std::function<bool()> &isCancelled,
+                                                const RowBitmap *allowed, QVector<int> *matched) const
+{
+    QStringList terms = tokenize(query);
+    terms.removeDuplicates();
+    int live = rowSlots.size();
+    if (terms.isEmpty() || limit <= 0 || live == 0) {
+        return QVector<Hit>();
+    }
+
+    // Sum each term's contribution per slot; only slots holding a term
+    // appear. Slots order like rows, so ties break the same way.
+    QHash<int, float> scores;
+    int scanned = 0;
+    for (const QString &term : terms) {
+        const QVector<int> *found = postings.find(term);
+        if (!found) {
+            continue;
+        }
+
+        const QVector<int> &list = *found;
+        float df = float(list.size());
+        float idf = std::log(1.0f + (float(live) - df + 0.5f) / (df + 0.5f));
+
+        for (int slot : list) {
+            if (isCancelled && ++scanned % CancelInterval == 0 && isCancelled()) {
+                return QVector<Hit>();
+            }
+
+            const RowStats &stats = slotStats[slot];
+            auto entry = std::lower_bound(stats.terms.cbegin(), stats.terms.cend(), term,
+                                          [](const Entry &e, const QString &t) { return e.term < t; });
+            scores[slot] += score(stats, *entry, idf);
+        }
+    }
+
+    // Bounded min-heap: the weakest of the best limit hits sits on top.
+    // Hits hold slots here; only the kept ones are turned into rows.
+    std::priority_queue<Hit, std::vector<Hit>, bool (*)(const Hit &, const Hit &)> heap(strongerHit);
+    for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
+        Hit hit = {it.key(), it.value()};
+        if (allowed && !allowed->test(rowSlots.rowOf(hit.row))) {
+            continue;
+        }
+        if (int(heap.size()) < limit) {
+            heap.push(hit);
+        } else if (strongerHit(hit, heap.top())) {
+            heap.pop();
+            heap.push(hit);
+        }
+    }
+
+    if (matched) {
+        QVector<int> slotList = scores.keys();
+        std::sort(slotList.begin(), slotList.end());
+        *matched = rowSlots.toRows(slotList);
+    }
+
+    QVector<Hit> hits(int(heap.size()));
+    for (int i = hits.size() - 1; i >= 0; --i) {
+        hits[i] = heap.top();
+        hits[i].row = rowSlots.rowOf(hits[i].row);
+        heap.pop();
+    }
+    return hits;
+}
+
+QStringList ProverbRanker::tokenize(const QString &text)
+{
+    QStringList tokens;
+    int start = -1;
+
+    for (int i = 0; i <= text.size(); ++i) {
+        // Marks carry Devanagari vowel signs and viramas, so they stay in the word
+        bool inWord = i < text.size() &&
+                      (text[i].isLetterOrNumber() || text[i].isMark() ||
+                       text[i].isHighSurrogate() || text[i].isLowSurrogate());
+        if (inWord && start < 0) {
+            start = i;
+        } else if (!inWord && start >= 0) {
+            tokens.append(text.mid(start, i - start));
+            start = -1;
+        }
+    }
+
+    return tokens;
+}
+
+ProverbRanker::RowStats ProverbRanker::statsFor(const Proverb &proverb)
+{
+    const QString *fields[FieldCount] = {
+        &proverb.proverb,
+        &proverb.transliteration,
+        &proverb.meaning,
+        &proverb.englishEquivalent,
+        &proverb.usageContext
+    };
+
+    RowStats stats;
+    QHash<QString, int> positions;
+
+    for (int f = 0; f < FieldCount; ++f) {
+        const QStringList tokens = tokenize(ProverbIndex::normalize(*fields[f]));
+        stats.lengths[f] = tokens.size();
+
+        for (const QString &token : tokens) {
+            auto pos = positions.constFind(token);
+            if (pos == positions.constEnd()) {
+                Entry entry;
+                entry.term = token;
+                std::fill(entry.frequency, entry.frequency + FieldCount, 0);
+                pos = positions.insert(token, stats.terms.size());
+                stats.terms.append(entry);
+            }
+
+            quint16 &frequency = stats.terms[pos.value()].frequency[f];
+            if (frequency < 0xFFFF) {
+                ++frequency;
+            }
+        }
+    }
+
+    std::sort(stats.terms.begin(), stats.terms.end(), [](const Entry &a, const Entry &b) {
+        return a.term < b.term;
+    });
+    return stats;
+}
+
+void ProverbRanker::addRow(int slot, const RowStats &stats)
+{
+    slotStats[slot] = stats;
+
+    for (int f = 0; f < FieldCount; ++f) {
+        totalLengths[f] += stats.lengths[f];
+    }
+
+    for (const Entry &entry : stats.terms) {
+        QVector<int> &list = postings[entry.term];
+        if (list.isEmpty() || list.last() < slot) {
+            list.append(slot);
+        } else {
+            list.insert(std::lower_bound(list.begin(), list.end(), slot), slot);
+        }
+    }
+}
+
+void ProverbRanker::removeRow(int slot)
+{
+    const RowStats &stats = slotStats.at(slot);
+
+    for (int f = 0; f < FieldCount; ++f) {
+        totalLengths[f] -= stats.lengths[f];
+    }
+
+    for (const Entry &entry : stats.terms) {
+        QVector<int> *list = postings.find(entry.term);
+        if (!list) {
+            continue;
+        }
+
+        auto pos = std::lower_bound(list->begin(), list->end(), slot);
+        if (pos != list->end() && *pos == slot) {
+            list->erase(pos);
+        }
+        if (list->isEmpty()) {
+            postings.remove(entry.term);
+        }
+    }
+
+    slotStats[slot] = RowStats();
+}
+
+void ProverbRanker::compact()
+{
+    const QVector<int> renumbered = rowSlots.compact();
+    postings.forEachMutable([&renumbered](const QString &, QVector<int> &list) {
+        RowSlots::renumber(list, renumbered);
+    });
+    slotStats = RowSlots::keepLive(slotStats, renumbered);
+}
+
+float ProverbRanker::score(const RowStats &stats, const Entry &entry, float idf) const
+{
+    // BM25F: length-normalized field frequencies are weighted and summed
+    // before the single saturation step
+    float frequency = 0.0f;
+    for (int f = 0; f < FieldCount; ++f) {
+        if (entry.frequency[f] == 0 || totalLengths[f] == 0) {
+            continue;
+        }
+
+        float averageLength = float(totalLengths[f]) / float(rowSlots.size());
+        float norm = 1.0f - B + B * float(stats.lengths[f]) / averageLength;
+        frequency += weights[f] * float(entry.frequency[f]) / norm;
+    }
+
+    return idf * frequency / (K1 + frequency);
+}
@@ -0,0 +1,87 @@
+#ifndef PROVERBRANKER_H
+#define PROVERBRANKER_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+#include "chunkedvector.h"
+#include "proverb.h"
+#include "rowbitmap.h"
+#include "rowslots.h"
+#include "shardedhash.h"
+
+// BM25F relevance ranking over the free-text proverb fields. Per-row term
+// frequencies, field lengths and document frequencies are kept in step with
+// the collection like ProverbIndex, and kept by slot the same way, so a
+// query only walks the posting lists of its own terms and a remove only
+// touches the removed record's.
+class ProverbRanker {
+public:
+    enum Field {
+        ProverbText,
+        Transliteration,
+        Meaning,
+        EnglishEquivalent,
+        UsageContext,
+        FieldCount
+    };
+
+    struct Hit {
+        int row;
+        float score;
+    };
+
+    ProverbRanker();
+
+    void build(const QList<Proverb> &proverbs);
+    void clear();
+
+    void append(const Proverb &proverb);
+    void update(int row, const Proverb &proverb);
+    void remove(int row);
+
+    // A match in a field counts weight times; zero ignores the field
+    void setWeight(Field field, float weight);
+    float weight(Field field) const;
+
+    // The best limit rows for a ProverbIndex::normalize()d query, highest
+    // score first. Only limit hits are ever held, however many rows match.
+    // allowed, when given, holds the only rows hits may come from; matched,
+    // when given, receives every row holding a query term, sorted.
+    QVector<Hit> topK(const QString &query, int limit,
+                      const std::function<bool()> &isCancelled = std::function<bool()>(),
+                      const RowBitmap *allowed = nullptr, QVector<int> *matched = nullptr) const;
+
+    // Words of already normalized text: runs of letters, digits and marks
+    static QStringList tokenize(const QString &text);
+
+private:
+    struct Entry {
+        QString term;
+        quint16 frequency[FieldCount];
+    };
+
+    struct RowStats {
+        QVector<Entry> terms;   // sorted by term
+        int lengths[FieldCount] = {};
+    };
+
+    static RowStats statsFor(const Proverb &proverb);
+    void addRow(int slot, const RowStats &stats);
+    void removeRow(int slot);
+    void compact();
+    float score(const RowStats &stats, const Entry &entry, float idf) const;
+
+    RowSlots rowSlots;
+    ShardedHash<QString, QVector<int>> postings;    // sorted slots
+    ChunkedVector<RowStats> slotStats;
+    qint64 totalLengths[FieldCount];
+    float weights[FieldCount];
+};
+
+#endif // PROVERBRANKER_H
@@ -0,0 +1,261 @@
+#include "proverbsnapshot.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+
+#include <cstring>
+
+namespace {
+const char Magic[4] = {'F', 'K', 'R', 'B'};
+const quint32 FormatVersion = 2;
+const quint32 ByteOrderMark = 0x01020304;
+}
+
+struct ProverbSnapshot::Header {
+    char magic[4];
+    quint32 version;
+    quint32 byteOrder;
+    quint32 recordCount;
+    quint32 tagRefCount;
+    quint32 reserved;
+    quint64 recordsOffset;
+    quint64 tagRefsOffset;
+    quint64 stringsOffset;
+    quint64 stringsLength;
+    qint64 sourceSize;
+};
+
+struct ProverbSnapshot::StringRef {
+    quint32 offset;
+    quint32 length;
+};
+
+struct ProverbSnapshot::Record {
+    quint64 id;
+    StringRef fields[FieldCount];
+    quint32 tagFirst;
+    quint32 tagCount;
+};
+
+ProverbSnapshot::~ProverbSnapshot()
+{
+    close();
+}
+
+bool ProverbSnapshot::open(const QString &path, const QString &jsonPath)
+{
+    close();
+
+    // A cache older than its JSON source is stale
+    QFileInfo binaryInfo(path);
+    QFileInfo jsonInfo(jsonPath);
+    if (!binaryInfo.exists() || !jsonInfo.exists() ||
+        binaryInfo.lastModified() < jsonInfo.lastModified()) {
+        return false;
+    }
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    length = file.size();
+    if (length >= qint64(sizeof(Header))) {
+        data = file.map(0, length);
+    }
+    if (!data) {
+        close();
+        return false;
+    }
+
+    // Reject foreign, truncated or outdated files before trusting any offset
+    const Header *h = header();
+    quint64 recordsEnd = h->recordsOffset + quint64(h->recordCount) * sizeof(Record);
+    quint64 tagRefsEnd = h->tagRefsOffset + quint64(h->tagRefCount) * sizeof(StringRef);
+    quint64 stringsEnd = h->stringsOffset + h->stringsLength * sizeof(char16_t);
+
+    bool valid = std::memcmp(h->magic, Magic, sizeof(Magic)) == 0 &&
+                 h->version == FormatVersion &&
+                 h->byteOrder == ByteOrderMark &&
+                 h->sourceSize == jsonInfo.size() &&
+                 h->recordsOffset % sizeof(quint64) == 0 &&
+                 h->stringsOffset % sizeof(char16_t) == 0 &&
+                 recordsEnd <= quint64(length) &&
+                 tagRefsEnd <= quint64(length) &&
+                 stringsEnd <= quint64(length);
+    if (!valid) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void ProverbSnapshot::close()
+{
+    if (data) {
+        file.unmap(const_cast<uchar *>(data));
+        data = nullptr;
+    }
+    length = 0;
+    file.close();
+}
+
+bool ProverbSnapshot::isOpen() const
+{
+    return data != nullptr;
+}
+
+int ProverbSnapshot::size() const
+{
+    return data ? int(header()->recordCount) : 0;
+}
+
+QStringView ProverbSnapshot::field(int index, Field field) const
+{
+    const Record *r = record(index);
+    return r ? string(r->fields[field]) : QStringView();
+}
+
+QStringList ProverbSnapshot::tags(int index) const
+{
+    QStringList result;
+    const Record *r = record(index);
+    if (!r || quint64(r->tagFirst) + r->tagCount > header()->tagRefCount) {
+        return result;
+    }
+
+    const StringRef *refs = reinterpret_cast<const StringRef *>(data + header()->tagRefsOffset);
+    result.reserve(r->tagCount);
+    for (quint32 i = 0; i < r->tagCount; ++i) {
+        QStringView tag = string(refs[r->tagFirst + i]);
+        result.append(QString::fromRawData(tag.data(), tag.size()));
+    }
+    return result;
+}
+
+Proverb ProverbSnapshot::proverb(int index) const
+{
+    // fromRawData shares the mapping; a string only copies once it is modified
+    auto view = [this, index](Field f) {
+        QStringView v = field(index, f);
+        return QString::fromRawData(v.data(), v.size());
+    };
+
+    Proverb p;
+    p.id = record(index) ? record(index)->id : 0;
+    p.proverb = view(ProverbText);
+    p.transliteration = view(Transliteration);
+    p.meaning = view(Meaning);
+    p.englishEquivalent = view(EnglishEquivalent);
+    p.tags = tags(index);
+    p.region = view(Region);
+    p.usageContext = view(UsageContext);
+    return p;
+}
+
+qint64 ProverbSnapshot::offsetOf(QStringView text) const
+{
+    if (!data || text.isEmpty()) {
+        return -1;
+    }
+
+    const QChar *strings = reinterpret_cast<const QChar *>(data + header()->stringsOffset);
+    const QChar *end = strings + header()->stringsLength;
+    if (text.data() < strings || text.data() + text.size() > end) {
+        return -1;
+    }
+    return text.data() - strings;
+}
+
+QStringView ProverbSnapshot::stringAt(quint32 offset, quint32 length) const
+{
+    return data ? string(StringRef{offset, length}) : QStringView();
+}
+
+bool ProverbSnapshot::write(const QString &path, const QList<Proverb> &proverbs, qint64 sourceSize)
+{
+    // Repeated strings such as tags and regions are stored once
+    QString strings;
+    QHash<QString, StringRef> interned;
+    auto intern = [&](const QString &s) {
+        auto it = interned.constFind(s);
+        if (it != interned.constEnd()) {
+            return it.value();
+        }
+        StringRef ref = {quint32(strings.size()), quint32(s.size())};
+        strings.append(s);
+        interned.insert(s, ref);
+        return ref;
+    };
+
+    QList<Record> records;
+    QList<StringRef> tagRefs;
+    records.reserve(proverbs.size());
+
+    for (const Proverb &p : proverbs) {
+        Record r;
+        r.id = p.id;
+        r.fields[ProverbText] = intern(p.proverb);
+        r.fields[Transliteration] = intern(p.transliteration);
+        r.fields[Meaning] = intern(p.meaning);
+        r.fields[EnglishEquivalent] = intern(p.englishEquivalent);
+        r.fields[Region] = intern(p.region);
+        r.fields[UsageContext] = intern(p.usageContext);
+        r.tagFirst = quint32(tagRefs.size());
+        r.tagCount = quint32(p.tags.size());
+        for (const QString &tag : p.tags) {
+            tagRefs.append(intern(tag));
+        }
+        records.append(r);
+    }
+
+    Header h;
+    std::memcpy(h.magic, Magic, sizeof(Magic));
+    h.version = FormatVersion;
+    h.byteOrder = ByteOrderMark;
+    h.recordCount = quint32(records.size());
+    h.tagRefCount = quint32(tagRefs.size());
+    h.reserved = 0;
+    h.recordsOffset = sizeof(Header);
+    h.tagRefsOffset = h.recordsOffset + quint64(records.size()) * sizeof(Record);
+    h.stringsOffset = h.tagRefsOffset + quint64(tagRefs.size()) * sizeof(StringRef);
+    h.stringsLength = quint64(strings.size());
+    h.sourceSize = sourceSize;
+
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char *>(records.constData()), records.size() * sizeof(Record));
+    out.write(reinterpret_cast<const char *>(tagRefs.constData()), tagRefs.size() * sizeof(StringRef));
+    out.write(reinterpret_cast<const char *>(strings.constData()), strings.size() * sizeof(char16_t));
+    return out.commit();
+}
+
+const ProverbSnapshot::Header *ProverbSnapshot::header() const
+{
+    return reinterpret_cast<const Header *>(data);
+}
+
+const ProverbSnapshot::Record *ProverbSnapshot::record(int index) const
+{
+    if (!data || index < 0 || quint32(index) >= header()->recordCount) {
+        return nullptr;
+    }
+    return reinterpret_cast<const Record *>(data + header()->recordsOffset) + index;
+}
+
+QStringView ProverbSnapshot::string(const StringRef &ref) const
+{
+    if (quint64(ref.offset) + ref.length > header()->stringsLength) {
+        return QStringView();
+    }
+
+    const QChar *strings = reinterpret_cast<const QChar *>(data + header()->stringsOffset);
+    return QStringView(strings + ref.offset, ref.length);
+}
@@ -0,0 +1,69 @@
+#ifndef PROVERBSNAPSHOT_H
+#define PROVERBSNAPSHOT_H
+
+#include <QFile>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+#include "proverb.h"
+
+// Memory-mapped binary cache of the JSON snapshot.
+//
+// Layout: a fixed header, a table of fixed-size records, a table of tag
+// references and a deduplicated UTF-16 string table. Every string is an
+// (offset, length) pair into that table, so fields are read in place.
+// Proverbs returned by proverb() share the mapped memory, so the snapshot
+// must stay open for as long as they are in use.
+class ProverbSnapshot {
+public:
+    enum Field {
+        ProverbText,
+        Transliteration,
+        Meaning,
+        EnglishEquivalent,
+        Region,
+        UsageContext,
+        FieldCount
+    };
+
+    ProverbSnapshot() = default;
+    ~ProverbSnapshot();
+
+    // Maps path if it was built from the current contents of jsonPath
+    bool open(const QString &path, const QString &jsonPath);
+    void close();
+    bool isOpen() const;
+
+    int size() const;
+    QStringView field(int record, Field field) const;
+    QStringList tags(int record) const;
+    Proverb proverb(int record) const;
+
+    // Offset of text in the string table when it is a view into this
+    // mapping, or -1; stringAt() turns it back into a view
+    qint64 offsetOf(QStringView text) const;
+    QStringView stringAt(quint32 offset, quint32 length) const;
+
+    static bool write(const QString &path, const QList<Proverb> &proverbs, qint64 sourceSize);
+
+private:
+    struct Header;
+    struct StringRef;
+    struct Record;
+
+    const Header *header() const;
+    const Record *record(int index) const;
+    QStringView string(const StringRef &ref) const;
+
+    QFile file;
+    const uchar *data = nullptr;
+    qint64 length = 0;
+};
+
+// Snapshots loaded strings may point into, e.g. one per collection shard
+typedef QList<QSharedPointer<const ProverbSnapshot>> MappedSnapshots;
+
+#endif // PROVERBSNAPSHOT_H
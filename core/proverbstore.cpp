@@ -0,0 +1,150 @@
+#include "proverbstore.h"
+
+#include <QtConcurrent>
+
+void ProverbStore::reset(QList<Proverb> proverbs, const MappedSnapshots &details)
+{
+    ProverbIdIndex::assignMissing(proverbs);
+    ++mutations;
+
+    // Every index only reads the list, so they build side by side; the
+    // facets take their tag ids from the columns once those are built
+    const QList<Proverb> &source = proverbs;
+    QList<QFuture<void>> builds = {
+        QtConcurrent::run([this, &source]() { searchIndex.build(source); }),
+        QtConcurrent::run([this, &source]() { rankIndex.build(source); }),
+        QtConcurrent::run([this, &source]() { completionIndex.build(source); }),
+        QtConcurrent::run([this, &source]() { ids.build(source); }),
+    };
+    records = ProverbColumns::fromList(source, details);
+    facetIndex.build(records);
+    for (QFuture<void> &build : builds) {
+        build.waitForFinished();
+    }
+    duplicateIndex.clear();
+    duplicatesTracked = false;
+}
+
+void ProverbStore::skipIdsTo(quint64 next)
+{
+    ids.skipTo(next);
+}
+
+Proverb ProverbStore::add(Proverb proverb)
+{
+    proverb.id = ids.allocate();
+    ++mutations;
+
+    records.append(proverb);
+    facetIndex.append(records);
+    searchIndex.append(proverb);
+    rankIndex.append(proverb);
+    completionIndex.append(proverb);
+    ids.append(proverb);
+    if (duplicatesTracked) {
+        duplicateIndex.insert(proverb.id, DuplicateIndex::signature(proverb.proverb, proverb.transliteration));
+    }
+    return proverb;
+}
+
+int ProverbStore::addAll(QList<Proverb> proverbs)
+{
+    records.reserve(records.size() + proverbs.size());
+    for (Proverb &proverb : proverbs) {
+        add(std::move(proverb));
+    }
+    return int(proverbs.size());
+}
+
+Proverb ProverbStore::edit(int row, Proverb proverb)
+{
+    proverb.id = records.id(row);
+    ++mutations;
+
+    records.update(row, proverb);
+    facetIndex.update(row, records);
+    searchIndex.update(row, proverb);
+    rankIndex.update(row, proverb);
+    completionIndex.update(row, proverb);
+    if (duplicatesTracked) {
+        duplicateIndex.insert(proverb.id, DuplicateIndex::signature(proverb.proverb, proverb.transliteration));
+    }
+    return proverb;
+}
+
+quint64 ProverbStore::remove(int row)
+{
+    quint64 id = records.id(row);
+    ++mutations;
+
+    facetIndex.remove(row);
+    searchIndex.remove(row);
+    rankIndex.remove(row);
+    completionIndex.remove(row);
+    records.remove(row);
+    ids.remove(id);
+    duplicateIndex.remove(id);
+    return id;
+}
+
+int ProverbStore::size() const
+{
+    return records.size();
+}
+
+quint64 ProverbStore::generation() const
+{
+    return mutations;
+}
+
+ProverbRef ProverbStore::at(int row) const
+{
+    return records.ref(row);
+}
+
+const ProverbColumns &ProverbStore::columns() const
+{
+    return records;
+}
+
+int ProverbStore::rowOf(quint64 id) const
+{
+    return ids.rowOf(id);
+}
+
+const ProverbIndex &ProverbStore::index() const
+{
+    return searchIndex;
+}
+
+const ProverbRanker &ProverbStore::ranker() const
+{
+    return rankIndex;
+}
+
+const ProverbFacets &ProverbStore::facets() const
+{
+    return facetIndex;
+}
+
+void ProverbStore::trackDuplicates(const QString &cachePath)
+{
+    duplicateIndex.build(records, cachePath);
+    duplicatesTracked = true;
+}
+
+const CompletionIndex &ProverbStore::completions() const
+{
+    return completionIndex;
+}
+
+const DuplicateIndex &ProverbStore::duplicates() const
+{
+    return duplicateIndex;
+}
+
+FilterResult ProverbStore::query(const ProverbFilter &filter,
+                                 const ProverbFilter::CancelCheck &isCancelled) const
+{
+    return filter.run(searchIndex, rankIndex, facetIndex, records.tagTerms(), isCancelled);
+}
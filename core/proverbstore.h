@@ -0,0 +1,76 @@
+#ifndef PROVERBSTORE_H
+#define PROVERBSTORE_H
+
+#include <QList>
+
+#include "completionindex.h"
+#include "duplicateindex.h"
+#include "proverb.h"
+#include "proverbcolumns.h"
+#include "proverbfacets.h"
+#include "proverbfilter.h"
+#include "proverbids.h"
+#include "proverbindex.h"
+#include "proverbranker.h"
+
+// The collection together with every index over it, kept in step through
+// add/edit/remove. Records live in ProverbColumns and are read through
+// ProverbRef views. Copies are implicitly shared, so a copy is a cheap
+// read-only snapshot that a query can run on from another thread. Storage
+// is chunked and sharded, so while a snapshot pins a version, an edit
+// clones only the chunks and shards it touches.
+class ProverbStore {
+public:
+    // Replaces the collection, giving records without an id a fresh one.
+    // With details, fields still pointing into those mapped snapshots stay
+    // there and are read on demand instead of being copied in. The indexes
+    // are built concurrently.
+    void reset(QList<Proverb> proverbs, const MappedSnapshots &details = MappedSnapshots());
+    // Ids below next are never handed out, so a record deleted before the
+    // last load doesn't lend its id to a new one; see ProverbBackend::nextId()
+    void skipIdsTo(quint64 next);
+
+    // Each returns the record as stored, with its id
+    Proverb add(Proverb proverb);
+    // Appends a whole batch, each record under a fresh id; returns the count
+    int addAll(QList<Proverb> proverbs);
+    Proverb edit(int row, Proverb proverb);
+    // Returns the id of the removed record
+    quint64 remove(int row);
+
+    int size() const;
+    // Bumped by every change, so results computed at one generation are
+    // known to be stale once it differs
+    quint64 generation() const;
+    // Valid until the store is next modified
+    ProverbRef at(int row) const;
+    const ProverbColumns &columns() const;
+    // Row of the record with this id, or -1
+    int rowOf(quint64 id) const;
+
+    const ProverbIndex &index() const;
+    const ProverbRanker &ranker() const;
+    const ProverbFacets &facets() const;
+    const CompletionIndex &completions() const;
+
+    // Starts keeping the near-duplicate index in step with the collection,
+    // reusing signatures cached at cachePath; reset() turns it off again
+    void trackDuplicates(const QString &cachePath = QString());
+    const DuplicateIndex &duplicates() const;
+
+    FilterResult query(const ProverbFilter &filter,
+                       const ProverbFilter::CancelCheck &isCancelled = ProverbFilter::CancelCheck()) const;
+
+private:
+    ProverbColumns records;
+    ProverbIndex searchIndex;
+    ProverbRanker rankIndex;
+    ProverbIdIndex ids;
+    ProverbFacets facetIndex;
+    CompletionIndex completionIndex;
+    DuplicateIndex duplicateIndex;
+    bool duplicatesTracked = false;
+    quint64 mutations = 0;
+};
+
+#endif // PROVERBSTORE_H
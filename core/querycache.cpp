@@ -0,0 +1,102 @@
+#include "querycache.h"
+
+#include <QMutexLocker>
+
+FilterResult QueryCache::query(const ProverbStore &store, const ProverbFilter &filter,
+                               const ProverbFilter::CancelCheck &isCancelled)
+{
+    quint64 generation = store.generation();
+    bool refinable = !filter.ranked && !filter.searchText.isEmpty();
+
+    QVector<int> wider;
+    bool haveWider = false;
+    {
+        QMutexLocker locker(&mutex);
+        int widest = -1;
+        for (int i = 0; i < entries.size(); ++i) {
+            const Entry &entry = entries[i];
+            if (entry.generation != generation) {
+                continue;
+            }
+
+            if (sameQuery(entry.filter, filter)) {
+                entries.move(i, 0);
+                return entries.first().result;
+            }
+
+            // The longest cached query this one extends leaves the fewest rows
+            if (refinable && !entry.filter.ranked && !entry.filter.searchText.isEmpty() &&
+                filter.searchText.contains(entry.filter.searchText) &&
+                (widest < 0 || entry.filter.searchText.size() > entries[widest].filter.searchText.size())) {
+                widest = i;
+            }
+        }
+        if (widest >= 0) {
+            wider = entries[widest].matches;
+            haveWider = true;
+        }
+    }
+
+    Entry entry;
+    entry.generation = generation;
+    entry.filter = filter;
+    if (refinable) {
+        entry.matches = ProverbFilter::substringMatches(store.index(), filter.searchText, isCancelled,
+                                                        haveWider ? &wider : nullptr);
+        if (isCancelled && isCancelled()) {
+            return FilterResult();
+        }
+        entry.result = filter.runWithMatches(entry.matches, store.index(), store.facets(),
+                                              store.columns().tagTerms());
+    } else {
+        entry.result = store.query(filter, isCancelled);
+        if (isCancelled && isCancelled()) {
+            return FilterResult();
+        }
+    }
+
+    insert(entry, generation);
+    return entry.result;
+}
+
+void QueryCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    entries.clear();
+}
+
+bool QueryCache::sameQuery(const ProverbFilter &a, const ProverbFilter &b)
+{
+    return a.searchText == b.searchText && a.tag == b.tag && a.region == b.region &&
+           a.ranked == b.ranked;
+}
+
+void QueryCache::insert(const Entry &entry, quint64 generation)
+{
+    QMutexLocker locker(&mutex);
+
+    // A worker still holding an older snapshot finished late
+    for (const Entry &existing : entries) {
+        if (existing.generation > generation) {
+            return;
+        }
+    }
+
+    // Entries from before a mutation can never be used again
+    qint64 rows = 0;
+    for (int i = entries.size() - 1; i >= 0; --i) {
+        if (entries[i].generation != generation || sameQuery(entries[i].filter, entry.filter)) {
+            entries.removeAt(i);
+        } else {
+            rows += entries[i].result.rows.size() + entries[i].matches.size();
+        }
+    }
+
+    entries.prepend(entry);
+    rows += entry.result.rows.size() + entry.matches.size();
+
+    while (entries.size() > 1 && (entries.size() > Capacity || rows > RowBudget)) {
+        rows -= entries.last().result.rows.size() + entries.last().matches.size();
+        entries.removeLast();
+    }
+}
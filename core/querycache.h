@@ -0,0 +1,45 @@
+#ifndef QUERYCACHE_H
+#define QUERYCACHE_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include "proverbfilter.h"
+#include "proverbstore.h"
+
+// Recent filter results, most recently used first, keyed by normalized
+// query, tag, region and ranking. Backspacing or going back to a facet is
+// a lookup. A query that extends a cached one only rechecks that one's
+// substring matches, since a row containing "bhat" also contains "bha".
+// Entries remember the store generation they were computed at and are
+// never used once the store has moved on.
+//
+// Thread-safe: the GUI thread and search workers may query concurrently.
+class QueryCache {
+public:
+    static const int Capacity = 32;
+    // Rows held across all entries before the oldest are dropped
+    static const int RowBudget = 4 * 1024 * 1024;
+
+    FilterResult query(const ProverbStore &store, const ProverbFilter &filter,
+                       const ProverbFilter::CancelCheck &isCancelled = ProverbFilter::CancelCheck());
+    void clear();
+
+private:
+    struct Entry {
+        quint64 generation;
+        ProverbFilter filter;
+        FilterResult result;
+        QVector<int> matches;   // substringMatches() of an unranked search
+    };
+
+    static bool sameQuery(const ProverbFilter &a, const ProverbFilter &b);
+    void insert(const Entry &entry, quint64 generation);
+
+    QMutex mutex;
+    QList<Entry> entries;
+};
+
+#endif // QUERYCACHE_H
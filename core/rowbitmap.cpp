@@ -0,0 +1,96 @@
+#include "rowbitmap.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+
+namespace {
+const int WordBits = 64;
+}
+
+RowBitmap RowBitmap::filled(int rows)
+{
+    RowBitmap bitmap;
+    bitmap.words.fill(~quint64(0), (rows + WordBits - 1) / WordBits);
+    if (rows % WordBits != 0) {
+        bitmap.words.last() = (quint64(1) << (rows % WordBits)) - 1;
+    }
+    return bitmap;
+}
+
+RowBitmap RowBitmap::fromRows(const QVector<int> &rows)
+{
+    RowBitmap bitmap;
+    for (int row : rows) {
+        bitmap.set(row);
+    }
+    return bitmap;
+}
+
+void RowBitmap::set(int row)
+{
+    int word = row / WordBits;
+    if (word >= words.size()) {
+        words.resize(word + 1, 0);
+    }
+    words[word] |= quint64(1) << (row % WordBits);
+}
+
+void RowBitmap::reset(int row)
+{
+    int word = row / WordBits;
+    if (word < words.size()) {
+        words[word] &= ~(quint64(1) << (row % WordBits));
+    }
+}
+
+bool RowBitmap::test(int row) const
+{
+    int word = row / WordBits;
+    return word < words.size() && (words[word] >> (row % WordBits)) & 1;
+}
+
+RowBitmap &RowBitmap::operator&=(const RowBitmap &other)
+{
+    if (words.size() > other.words.size()) {
+        words.resize(other.words.size());
+    }
+    for (int i = 0; i < words.size(); ++i) {
+        words[i] &= other.words[i];
+    }
+    return *this;
+}
+
+int RowBitmap::count() const
+{
+    int total = 0;
+    for (quint64 word : words) {
+        total += qPopulationCount(word);
+    }
+    return total;
+}
+
+int RowBitmap::countAnd(const RowBitmap &other) const
+{
+    int total = 0;
+    int shared = std::min(words.size(), other.words.size());
+    for (int i = 0; i < shared; ++i) {
+        total += qPopulationCount(words[i] & other.words[i]);
+    }
+    return total;
+}
+
+QVector<int> RowBitmap::rows() const
+{
+    QVector<int> result;
+    result.reserve(count());
+
+    for (int i = 0; i < words.size(); ++i) {
+        quint64 word = words[i];
+        while (word) {
+            result.append(i * WordBits + qCountTrailingZeroBits(word));
+            word &= word - 1;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,27 @@
+#ifndef ROWBITMAP_H
+#define ROWBITMAP_H
+
+#include <QVector>
+
+// Plain bitset over collection rows or slots. Bits past the last stored
+// word read as unset, so bitmaps of different lengths combine naturally.
+class RowBitmap {
+public:
+    static RowBitmap filled(int rows);
+    static RowBitmap fromRows(const QVector<int> &rows);
+
+    void set(int row);
+    void reset(int row);
+    bool test(int row) const;
+
+    RowBitmap &operator&=(const RowBitmap &other);
+
+    int count() const;
+    int countAnd(const RowBitmap &other) const;
+    QVector<int> rows() const;
+
+private:
+    QVector<quint64> words;
+};
+
+#endif // ROWBITMAP_H
@@ -0,0 +1,140 @@
+#include "rowslots.h"
+
+#include <algorithm>
+
+namespace {
+// Fewer dead slots than this are never worth a renumbering pass
+const int MinCompaction = 64;
+
+// Dead slots before the slot of row. dead[i] - i counts the live slots
+// before dead[i] and never decreases, so it can be searched like dead.
+int deadBefore(const QVector<int> &dead, int row)
+{
+    int low = 0;
+    int high = int(dead.size());
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (dead[middle] - middle <= row) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+}
+
+void RowSlots::clear()
+{
+    dead.clear();
+    issued = 0;
+}
+
+int RowSlots::append()
+{
+    return issued++;
+}
+
+int RowSlots::remove(int row)
+{
+    int skipped = deadBefore(dead, row);
+    dead.insert(skipped, row + skipped);
+    return row + skipped;
+}
+
+int RowSlots::size() const
+{
+    return issued - int(dead.size());
+}
+
+int RowSlots::slotCount() const
+{
+    return issued;
+}
+
+int RowSlots::slotOf(int row) const
+{
+    return dead.isEmpty() ? row : row + deadBefore(dead, row);
+}
+
+int RowSlots::rowOf(int slot) const
+{
+    auto it = std::lower_bound(dead.cbegin(), dead.cend(), slot);
+    if (it != dead.cend() && *it == slot) {
+        return -1;
+    }
+    return slot - int(it - dead.cbegin());
+}
+
+QVector<int> RowSlots::toRows(const QVector<int> &sorted) const
+{
+    // Until something is removed slots are rows, and the list is shared
+    if (dead.isEmpty()) {
+        return sorted;
+    }
+
+    QVector<int> rows;
+    rows.reserve(sorted.size());
+    int skipped = 0;
+    for (int slot : sorted) {
+        while (skipped < dead.size() && dead[skipped] < slot) {
+            ++skipped;
+        }
+        if (skipped < dead.size() && dead[skipped] == slot) {
+            continue;
+        }
+        rows.append(slot - skipped);
+    }
+    return rows;
+}
+
+QVector<int> RowSlots::toSlots(const QVector<int> &sortedRows) const
+{
+    if (dead.isEmpty()) {
+        return sortedRows;
+    }
+
+    // Rows only grow, so the dead slots before each are counted as they pass
+    QVector<int> result;
+    result.reserve(sortedRows.size());
+    int skipped = 0;
+    for (int row : sortedRows) {
+        while (skipped < dead.size() && dead[skipped] - skipped <= row) {
+            ++skipped;
+        }
+        result.append(row + skipped);
+    }
+    return result;
+}
+
+bool RowSlots::wantsCompaction() const
+{
+    int count = int(dead.size());
+    return count >= MinCompaction && count * 4 > size();
+}
+
+QVector<int> RowSlots::compact()
+{
+    QVector<int> renumbered(issued);
+    int next = 0;
+    int skipped = 0;
+    for (int slot = 0; slot < issued; ++slot) {
+        if (skipped < dead.size() && dead[skipped] == slot) {
+            renumbered[slot] = -1;
+            ++skipped;
+        } else {
+            renumbered[slot] = next++;
+        }
+    }
+
+    dead.clear();
+    issued = next;
+    return renumbered;
+}
+
+void RowSlots::renumber(QVector<int> &list, const QVector<int> &renumbered)
+{
+    for (int &slot : list) {
+        slot = renumbered[slot];
+    }
+}
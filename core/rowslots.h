@@ -0,0 +1,63 @@
+#ifndef ROWSLOTS_H
+#define ROWSLOTS_H
+
+#include <QVector>
+
+// Stable slot numbers for the rows of a collection. A record keeps the slot
+// it was appended under for as long as it lives, and removing it only marks
+// that slot dead, so an index keyed by slot never renumbers anything when a
+// row goes. Slots follow collection order like rows, so sorted slots map to
+// sorted rows. Only the dead slots are stored, sorted: translating costs a
+// search over them, and clear() starts over with none. Owners call
+// compact() once wantsCompaction() says the dead slots have piled up, and
+// renumber what they keep by slot with the table it returns.
+class RowSlots {
+public:
+    void clear();
+
+    // Slot of a new last row
+    int append();
+    // Marks the row's slot dead and returns it
+    int remove(int row);
+
+    // Live rows, and every slot handed out including dead ones
+    int size() const;
+    int slotCount() const;
+
+    int slotOf(int row) const;
+    // Row of a live slot, or -1 for a dead one
+    int rowOf(int slot) const;
+
+    // Sorted slots as sorted rows, dropping dead ones, and back
+    QVector<int> toRows(const QVector<int> &sorted) const;
+    QVector<int> toSlots(const QVector<int> &sortedRows) const;
+
+    // True once the dead slots outnumber a quarter of the live ones
+    bool wantsCompaction() const;
+    // Forgets the dead slots, so every live slot becomes its row again.
+    // Returns the new slot of each old one, -1 for the dead.
+    QVector<int> compact();
+
+    // Renumbers a list of live slots per a compact() table; order is kept
+    static void renumber(QVector<int> &list, const QVector<int> &renumbered);
+
+    // Values of the live slots in order, per a compact() table
+    template <typename Vector>
+    static Vector keepLive(const Vector &values, const QVector<int> &renumbered)
+    {
+        Vector kept;
+        kept.reserve(values.size());
+        for (int slot = 0; slot < renumbered.size(); ++slot) {
+            if (renumbered[slot] >= 0) {
+                kept.append(values.at(slot));
+            }
+        }
+        return kept;
+    }
+
+private:
+    QVector<int> dead;
+    int issued = 0;
+};
+
+#endif // ROWSLOTS_H
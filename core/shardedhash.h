@@ -0,0 +1,119 @@
+#ifndef SHARDEDHASH_H
+#define SHARDEDHASH_H
+
+#include <QHash>
+#include <QVector>
+
+// Hash split over ShardCount implicitly shared QHashes by key. A copy
+// shares every shard, and writing to it detaches only the shard the key
+// falls in, so a snapshot costs an edit 1/ShardCount of a full deep copy.
+// Iteration goes shard by shard, in no particular order.
+template <typename K, typename V>
+class ShardedHash {
+public:
+    static const int ShardBits = 8;
+    static const int ShardCount = 1 << ShardBits;
+
+    int size() const
+    {
+        int total = 0;
+        for (const QHash<K, V> &shard : shards) {
+            total += int(shard.size());
+        }
+        return total;
+    }
+
+    void clear() { shards.clear(); }
+
+    void reserve(int size)
+    {
+        ensureShards();
+        for (QHash<K, V> &shard : shards) {
+            shard.reserve(size / ShardCount + 1);
+        }
+    }
+
+    bool contains(const K &key) const { return find(key) != nullptr; }
+
+    V value(const K &key, const V &fallback = V()) const
+    {
+        const V *found = find(key);
+        return found ? *found : fallback;
+    }
+
+    // nullptr when absent
+    const V *find(const K &key) const
+    {
+        if (shards.isEmpty()) {
+            return nullptr;
+        }
+        const QHash<K, V> &shard = shards.at(shardOf(key));
+        auto it = shard.constFind(key);
+        return it == shard.constEnd() ? nullptr : &it.value();
+    }
+
+    V *find(const K &key)
+    {
+        if (shards.isEmpty() || !shards.at(shardOf(key)).contains(key)) {
+            return nullptr;
+        }
+        return &shards[shardOf(key)][key];
+    }
+
+    V &operator[](const K &key)
+    {
+        ensureShards();
+        return shards[shardOf(key)][key];
+    }
+
+    void insert(const K &key, const V &value) { (*this)[key] = value; }
+
+    bool remove(const K &key)
+    {
+        if (shards.isEmpty() || !shards.at(shardOf(key)).contains(key)) {
+            return false;
+        }
+        return shards[shardOf(key)].remove(key);
+    }
+
+    // f(key, value) for every entry
+    template <typename F>
+    void forEach(F f) const
+    {
+        for (const QHash<K, V> &shard : shards) {
+            for (auto it = shard.constBegin(); it != shard.constEnd(); ++it) {
+                f(it.key(), it.value());
+            }
+        }
+    }
+
+    // As forEach() with a modifiable value; detaches every shard
+    template <typename F>
+    void forEachMutable(F f)
+    {
+        for (QHash<K, V> &shard : shards) {
+            for (auto it = shard.begin(); it != shard.end(); ++it) {
+                f(it.key(), it.value());
+            }
+        }
+    }
+
+private:
+    static int shardOf(const K &key)
+    {
+        // The top bits of a multiplicative mix spread sequential ids too
+        quint64 hash = quint64(qHash(key, 0)) * 0x9e3779b97f4a7c15ull;
+        return int(hash >> (64 - ShardBits));
+    }
+
+    void ensureShards()
+    {
+        if (shards.isEmpty()) {
+            shards.resize(ShardCount);
+        }
+    }
+
+    QVector<QHash<K, V>> shards;
+};
+
+#endif // SHARDEDHASH_H
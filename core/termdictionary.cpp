@@ -0,0 +1,79 @@
+#include "termdictionary.h"
+
+#include <algorithm>
+
+int TermDictionary::intern(const QString &term)
+{
+    auto it = ids.constFind(term);
+    if (it != ids.constEnd()) {
+        ++counts[it.value()];
+        return it.value();
+    }
+
+    // Reuse ids of terms that dropped out of the vocabulary
+    int id;
+    if (!freeIds.isEmpty()) {
+        id = freeIds.takeLast();
+        terms[id] = term;
+        counts[id] = 1;
+    } else {
+        id = terms.size();
+        terms.append(term);
+        counts.append(1);
+    }
+    ids.insert(term, id);
+    sorted.insert(std::lower_bound(sorted.begin(), sorted.end(), term), term);
+    return id;
+}
+
+void TermDictionary::release(int id)
+{
+    if (id < 0 || id >= counts.size() || counts[id] == 0) {
+        return;
+    }
+
+    if (--counts[id] == 0) {
+        const QString &term = terms[id];
+        auto pos = std::lower_bound(sorted.begin(), sorted.end(), term);
+        if (pos != sorted.end() && *pos == term) {
+            sorted.erase(pos);
+        }
+        ids.remove(term);
+        terms[id].clear();
+        freeIds.append(id);
+    }
+}
+
+int TermDictionary::find(const QString &term) const
+{
+    return ids.value(term, NoTerm);
+}
+
+QString TermDictionary::term(int id) const
+{
+    return id >= 0 && id < terms.size() ? terms[id] : QString();
+}
+
+int TermDictionary::idLimit() const
+{
+    return terms.size();
+}
+
+int TermDictionary::count(int id) const
+{
+    return id >= 0 && id < counts.size() ? counts[id] : 0;
+}
+
+const QStringList &TermDictionary::sortedTerms() const
+{
+    return sorted;
+}
+
+void TermDictionary::clear()
+{
+    ids.clear();
+    terms.clear();
+    counts.clear();
+    freeIds.clear();
+    sorted.clear();
+}
@@ -0,0 +1,37 @@
+#ifndef TERMDICTIONARY_H
+#define TERMDICTIONARY_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Interns terms such as tags or regions to small integer ids and keeps
+// the sorted vocabulary of terms still in use up to date as they come and go.
+class TermDictionary {
+public:
+    static const int NoTerm = -1;
+
+    // Returns the id for term, adding a reference to it
+    int intern(const QString &term);
+    // Drops a reference; the term leaves the vocabulary at zero
+    void release(int id);
+
+    int find(const QString &term) const;
+    QString term(int id) const;
+    // Ids range over [0, idLimit()); freed ids have a count of zero
+    int idLimit() const;
+    int count(int id) const;
+    const QStringList &sortedTerms() const;
+
+    void clear();
+
+private:
+    QHash<QString, int> ids;
+    QStringList terms;
+    QVector<int> counts;
+    QVector<int> freeIds;
+    QStringList sorted;
+};
+
+#endif // TERMDICTIONARY_H
@@ -0,0 +1,87 @@
+#include "utf16search.h"
+
+#include <QtAlgorithms>
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FAKRA_SEARCH_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FAKRA_SEARCH_SSE2
+#endif
+
+namespace {
+// Checks the code units between the first and last, which the vector
+// compare has already matched
+inline bool matchesInner(const char16_t *at, const char16_t *needle, qsizetype needleLength)
+{
+    return needleLength <= 2 ||
+           std::memcmp(at + 1, needle + 1, (needleLength - 2) * sizeof(char16_t)) == 0;
+}
+}
+
+qsizetype utf16Find(const char16_t *haystack, qsizetype length,
+                    const char16_t *needle, qsizetype needleLength)
+{
+    if (needleLength == 0) {
+        return 0;
+    }
+    if (needleLength > length) {
+        return -1;
+    }
+
+    // Candidate starts are [0, starts); i runs over them block by block
+    const qsizetype starts = length - needleLength + 1;
+    const char16_t *tail = haystack + needleLength - 1;
+    qsizetype i = 0;
+
+#if defined(FAKRA_SEARCH_AVX2)
+    const __m256i first = _mm256_set1_epi16(short(needle[0]));
+    const __m256i last = _mm256_set1_epi16(short(needle[needleLength - 1]));
+    for (; i + 16 <= starts; i += 16) {
+        __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i));
+        __m256i end = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(tail + i));
+        __m256i hits = _mm256_and_si256(_mm256_cmpeq_epi16(head, first), _mm256_cmpeq_epi16(end, last));
+
+        // Every matching 16-bit lane sets two adjacent mask bits
+        quint32 mask = quint32(_mm256_movemask_epi8(hits));
+        while (mask) {
+            int bit = qCountTrailingZeroBits(mask);
+            if (matchesInner(haystack + i + bit / 2, needle, needleLength)) {
+                return i + bit / 2;
+            }
+            mask &= ~(3u << bit);
+        }
+    }
+#elif defined(FAKRA_SEARCH_SSE2)
+    const __m128i first = _mm_set1_epi16(short(needle[0]));
+    const __m128i last = _mm_set1_epi16(short(needle[needleLength - 1]));
+    for (; i + 8 <= starts; i += 8) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i));
+        __m128i end = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tail + i));
+        __m128i hits = _mm_and_si128(_mm_cmpeq_epi16(head, first), _mm_cmpeq_epi16(end, last));
+
+        // Every matching 16-bit lane sets two adjacent mask bits
+        quint32 mask = quint32(_mm_movemask_epi8(hits));
+        while (mask) {
+            int bit = qCountTrailingZeroBits(mask);
+            if (matchesInner(haystack + i + bit / 2, needle, needleLength)) {
+                return i + bit / 2;
+            }
+            mask &= ~(3u << bit);
+        }
+    }
+#endif
+
+    // Scalar path for the remaining starts, or all of them without SIMD
+    for (; i < starts; ++i) {
+        if (haystack[i] == needle[0] && tail[i] == needle[needleLength - 1] &&
+            matchesInner(haystack + i, needle, needleLength)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
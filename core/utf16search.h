@@ -0,0 +1,21 @@
+#ifndef UTF16SEARCH_H
+#define UTF16SEARCH_H
+
+#include <QString>
+#include <QStringView>
+
+// Vectorized UTF-16 substring search. Candidate positions are found by
+// comparing the needle's first and last code units against 16 (AVX2) or
+// 8 (SSE2) haystack positions at once, then verified with memcmp. Builds
+// without either instruction set use the scalar loop.
+
+// Offset of the first occurrence of needle in haystack, or -1
+qsizetype utf16Find(const char16_t *haystack, qsizetype length,
+                    const char16_t *needle, qsizetype needleLength);
+
+inline bool utf16Contains(QStringView haystack, QStringView needle)
+{
+    return utf16Find(haystack.utf16(), haystack.size(), needle.utf16(), needle.size()) >= 0;
+}
+
+#endif // UTF16SEARCH_H
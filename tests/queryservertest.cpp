@@ -0,0 +1,275 @@
+#include <QDeadlineTimer>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpSocket>
+#include <QtTest>
+
+#include "proverbstore.h"
+#include "queryserver.h"
+
+// The query server's HTTP surface, served from a small fixed corpus on an
+// ephemeral local port: paging, facet filters, keep-alive with pipelined
+// requests, the error statuses and /metrics. The server accepts on this
+// thread's event loop, so the client never blocks it: replies are
+// collected between QTest::qWait() slices.
+class QueryServerTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void searchPage();
+    void searchFilters();
+    void pipelinedKeepAlive();
+    void errors_data();
+    void errors();
+    void metrics();
+
+private:
+    struct Reply {
+        int status = 0;
+        QByteArray connection;
+        QJsonObject body;
+    };
+
+    static QList<Proverb> corpus();
+    static QByteArray get(const QByteArray &target);
+    static bool takeReply(QByteArray &buffer, QList<Reply> *replies);
+    bool connectClient(QTcpSocket &socket);
+    QList<Reply> exchange(QTcpSocket &socket, const QByteArray &requests, int count);
+    Reply request(const QByteArray &requests);
+
+    ProverbStore store;
+    QScopedPointer<QueryServer> server;
+};
+
+void QueryServerTest::initTestCase()
+{
+    store.reset(corpus());
+    server.reset(new QueryServer(store, 2));
+    QVERIFY(server->listen(QHostAddress::LocalHost, 0));
+    QVERIFY(server->serverPort() != 0);
+}
+
+void QueryServerTest::searchPage()
+{
+    Reply reply = request(get("/search?q=river&offset=10&limit=5"));
+    QCOMPARE(reply.status, 200);
+    QCOMPARE(reply.body["count"].toInt(), 30);
+    QCOMPARE(reply.body["offset"].toInt(), 10);
+    QCOMPARE(reply.body["limit"].toInt(), 5);
+
+    // Unranked matches come in collection order
+    const QJsonArray results = reply.body["results"].toArray();
+    QCOMPARE(results.size(), 5);
+    for (int i = 0; i < results.size(); ++i) {
+        QCOMPARE(results[i].toObject()["proverb"].toString(), QString("river saying %1").arg(10 + i));
+    }
+
+    // Past the end there is nothing left, but the count still holds
+    reply = request(get("/search?q=river&offset=28&limit=5"));
+    QCOMPARE(reply.body["results"].toArray().size(), 2);
+    reply = request(get("/search?q=river&offset=40"));
+    QCOMPARE(reply.status, 200);
+    QCOMPARE(reply.body["count"].toInt(), 30);
+    QVERIFY(reply.body["results"].toArray().isEmpty());
+}
+
+void QueryServerTest::searchFilters()
+{
+    Reply reply = request(get("/search?q=river&tag=odd&limit=100"));
+    QCOMPARE(reply.status, 200);
+    QCOMPARE(reply.body["count"].toInt(), 15);
+    for (const QJsonValue &value : reply.body["results"].toArray()) {
+        QVERIFY(value.toObject()["tags"].toArray().contains(QJsonValue("odd")));
+    }
+    // Regions are counted under the tag selection
+    QCOMPARE(reply.body["regions"].toObject()["Mithila"].toInt(), 5);
+    QCOMPARE(reply.body["regions"].toObject()["Darbhanga"].toInt(), 10);
+
+    reply = request(get("/search?q=river&region=Mithila&limit=100"));
+    QCOMPARE(reply.body["count"].toInt(), 10);
+    for (const QJsonValue &value : reply.body["results"].toArray()) {
+        QCOMPARE(value.toObject()["region"].toString(), QString("Mithila"));
+    }
+    QCOMPARE(reply.body["tags"].toObject()["even"].toInt(), 5);
+    QCOMPARE(reply.body["tags"].toObject()["odd"].toInt(), 5);
+
+    // Both at once: odd multiples of three
+    reply = request(get("/search?q=river&tag=odd&region=Mithila"));
+    QCOMPARE(reply.body["count"].toInt(), 5);
+    QCOMPARE(reply.body["results"].toArray().first().toObject()["proverb"].toString(),
+             QString("river saying 3"));
+
+    // Ranked results honour the filters too
+    reply = request(get("/search?q=river&tag=odd&region=Mithila&ranked=1"));
+    QCOMPARE(reply.body["count"].toInt(), 5);
+    QCOMPARE(reply.body["results"].toArray().size(), 5);
+
+    reply = request(get("/search?q=river&tag=missing"));
+    QCOMPARE(reply.status, 200);
+    QCOMPARE(reply.body["count"].toInt(), 0);
+}
+
+void QueryServerTest::pipelinedKeepAlive()
+{
+    QTcpSocket socket;
+    QVERIFY(connectClient(socket));
+
+    // Both requests go out in one write; the second waits in the server's
+    // buffer until the first is answered
+    QList<Reply> replies = exchange(socket, get("/search?q=mountain") + get("/search?q=river&limit=1"), 2);
+    QCOMPARE(replies.size(), 2);
+    QCOMPARE(replies[0].status, 200);
+    QCOMPARE(replies[0].body["count"].toInt(), 2);
+    QCOMPARE(replies[0].connection, QByteArray("keep-alive"));
+    QCOMPARE(replies[1].status, 200);
+    QCOMPARE(replies[1].body["count"].toInt(), 30);
+    QCOMPARE(replies[1].connection, QByteArray("keep-alive"));
+
+    // The connection is still open for a third
+    QCOMPARE(socket.state(), QAbstractSocket::ConnectedState);
+    replies = exchange(socket, "GET /search?q=mountain HTTP/1.1\r\nConnection: close\r\n\r\n", 1);
+    QCOMPARE(replies.size(), 1);
+    QCOMPARE(replies[0].connection, QByteArray("close"));
+    QTRY_COMPARE(socket.state(), QAbstractSocket::UnconnectedState);
+}
+
+void QueryServerTest::errors_data()
+{
+    QTest::addColumn<QByteArray>("requests");
+    QTest::addColumn<int>("status");
+
+    QTest::newRow("malformed") << QByteArray("nonsense\r\n\r\n") << 400;
+    QTest::newRow("not http") << QByteArray("GET /search SPDY/3\r\n\r\n") << 400;
+    QTest::newRow("negative offset") << get("/search?q=river&offset=-1") << 400;
+    QTest::newRow("bad limit") << get("/search?q=river&limit=many") << 400;
+    QTest::newRow("unknown path") << get("/proverbs") << 404;
+    QTest::newRow("post") << QByteArray("POST /search HTTP/1.1\r\nContent-Length: 4\r\n\r\nq=no") << 405;
+    QTest::newRow("delete") << QByteArray("DELETE /search HTTP/1.1\r\n\r\n") << 405;
+}
+
+void QueryServerTest::errors()
+{
+    QFETCH(QByteArray, requests);
+    QFETCH(int, status);
+
+    Reply reply = request(requests);
+    QCOMPARE(reply.status, status);
+    QVERIFY(!reply.body["error"].toString().isEmpty());
+}
+
+void QueryServerTest::metrics()
+{
+    QCOMPARE(request(get("/search?q=river")).status, 200);
+
+    Reply reply = request(get("/metrics"));
+    QCOMPARE(reply.status, 200);
+    QVERIFY(reply.body.contains("uptime_ms"));
+    QJsonObject scopes = reply.body["scopes"].toObject();
+    QVERIFY(scopes["serverQuery"].toObject()["count"].toInt() >= 1);
+    QVERIFY(scopes["serverRequest"].toObject()["count"].toInt() >= 1);
+}
+
+QList<Proverb> QueryServerTest::corpus()
+{
+    // Thirty river sayings, alternately tagged even and odd, every third
+    // from Mithila, plus two that match nothing else
+    QList<Proverb> proverbs;
+    for (int i = 0; i < 30; ++i) {
+        Proverb proverb;
+        proverb.proverb = QString("river saying %1").arg(i);
+        proverb.transliteration = proverb.proverb;
+        proverb.meaning = "A test record";
+        proverb.tags = {i % 2 ? "odd" : "even"};
+        proverb.region = i % 3 == 0 ? "Mithila" : "Darbhanga";
+        proverbs.append(proverb);
+    }
+    for (int i = 0; i < 2; ++i) {
+        Proverb proverb;
+        proverb.proverb = QString("mountain saying %1").arg(i);
+        proverb.transliteration = proverb.proverb;
+        proverb.tags = {"high"};
+        proverb.region = "Darbhanga";
+        proverbs.append(proverb);
+    }
+    return proverbs;
+}
+
+QByteArray QueryServerTest::get(const QByteArray &target)
+{
+    return "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+}
+
+bool QueryServerTest::takeReply(QByteArray &buffer, QList<Reply> *replies)
+{
+    qsizetype end = buffer.indexOf("\r\n\r\n");
+    if (end < 0) {
+        return false;
+    }
+
+    Reply reply;
+    qsizetype length = 0;
+    const QList<QByteArray> lines = buffer.left(end).split('\n');
+    reply.status = lines.first().split(' ').value(1).toInt();
+    for (int i = 1; i < lines.size(); ++i) {
+        QByteArray name = lines[i].section(':', 0, 0).trimmed().toLower();
+        QByteArray value = lines[i].section(':', 1).trimmed();
+        if (name == "content-length") {
+            length = value.toLongLong();
+        } else if (name == "connection") {
+            reply.connection = value;
+        }
+    }
+    if (buffer.size() < end + 4 + length) {
+        return false;
+    }
+
+    reply.body = QJsonDocument::fromJson(buffer.mid(end + 4, length)).object();
+    buffer.remove(0, end + 4 + length);
+    replies->append(reply);
+    return true;
+}
+
+bool QueryServerTest::connectClient(QTcpSocket &socket)
+{
+    socket.connectToHost(QHostAddress::LocalHost, server->serverPort());
+    QDeadlineTimer deadline(5000);
+    while (socket.state() != QAbstractSocket::ConnectedState && !deadline.hasExpired()) {
+        QTest::qWait(10);
+    }
+    return socket.state() == QAbstractSocket::ConnectedState;
+}
+
+QList<QueryServerTest::Reply> QueryServerTest::exchange(QTcpSocket &socket, const QByteArray &requests,
+                                                        int count)
+{
+    socket.write(requests);
+
+    QList<Reply> replies;
+    QByteArray buffer;
+    QDeadlineTimer deadline(5000);
+    while (replies.size() < count && !deadline.hasExpired()) {
+        if (!takeReply(buffer, &replies)) {
+            QTest::qWait(10);
+            buffer.append(socket.readAll());
+        }
+    }
+    return replies;
+}
+
+QueryServerTest::Reply QueryServerTest::request(const QByteArray &requests)
+{
+    QTcpSocket socket;
+    if (!connectClient(socket)) {
+        return Reply();
+    }
+    QList<Reply> replies = exchange(socket, requests, 1);
+    return replies.isEmpty() ? Reply() : replies.first();
+}
+
+QTEST_GUILESS_MAIN(QueryServerTest)
+
+#include "queryservertest.moc"
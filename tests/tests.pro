@@ -0,0 +1,13 @@
+QT = core concurrent network testlib sql
+
+TARGET = fakra-tests
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+include(../core/fakra_core.pri)
+
+INCLUDEPATH += ../cli
+
+SOURCES += queryservertest.cpp ../cli/queryserver.cpp
+HEADERS += ../cli/queryserver.h